@@ -0,0 +1,233 @@
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include "esphome/core/log.h"
+#include "esphome/core/helpers.h"
+
+#include "auth_index.h"
+
+namespace esphome {
+namespace nuki_lock {
+
+static const char *TAG = "nuki_lock.auth";
+
+const char *AuthIndex::find(uint32_t auth_id) const {
+    const size_t i = this->lower_bound_(auth_id);
+    if (i < this->count_ && this->entries_[i].auth_id == auth_id) {
+        return this->pool_ + this->entries_[i].name_offset;
+    }
+    return nullptr;
+}
+
+bool AuthIndex::add(uint32_t auth_id, const char *name) {
+    if (!this->allocate_()) {
+        return false;
+    }
+
+    const size_t i = this->lower_bound_(auth_id);
+    const bool exists = i < this->count_ && this->entries_[i].auth_id == auth_id;
+
+    if (exists && strcmp(this->pool_ + this->entries_[i].name_offset, name) == 0) {
+        this->entries_[i].seen = 1;
+        return true;
+    }
+
+    if (!exists && this->is_full()) {
+        ESP_LOGW(TAG, "Index full, ignoring auth id %u", auth_id);
+        return false;
+    }
+
+    uint16_t offset = 0;
+    if (!this->intern_(name, &offset)) {
+        ESP_LOGW(TAG, "Name pool full, ignoring auth id %u", auth_id);
+        return false;
+    }
+
+    if (!exists) {
+        memmove(&this->entries_[i + 1], &this->entries_[i], (this->count_ - i) * sizeof(AuthIndexEntry));
+        this->entries_[i].auth_id = auth_id;
+        this->entries_[i].reserved = 0;
+        this->count_++;
+    }
+
+    this->entries_[i].name_offset = offset;
+    this->entries_[i].seen = 1;
+    return true;
+}
+
+void AuthIndex::clear() {
+    this->count_ = 0;
+    this->pool_used_ = 0;
+}
+
+void AuthIndex::begin_refresh() {
+    for (size_t i = 0; i < this->count_; i++) {
+        this->entries_[i].seen = 0;
+    }
+}
+
+void AuthIndex::finish_refresh() {
+    size_t kept = 0;
+    for (size_t i = 0; i < this->count_; i++) {
+        if (this->entries_[i].seen) {
+            this->entries_[kept++] = this->entries_[i];
+        }
+    }
+
+    if (kept != this->count_) {
+        ESP_LOGD(TAG, "Removed %u stale auth entries", this->count_ - kept);
+        this->count_ = kept;
+    }
+
+    this->compact_pool_();
+    ESP_LOGD(TAG, "Auth index holds %u entries, %u bytes of names", this->count_, this->pool_used_);
+}
+
+void AuthIndex::save(AuthIndexSnapshot *snapshot) const {
+    snapshot->count = this->count_;
+    snapshot->pool_used = this->pool_used_;
+    if (this->count_ == 0) {
+        return;
+    }
+    memcpy(snapshot->entries, this->entries_, this->count_ * sizeof(AuthIndexEntry));
+    memcpy(snapshot->pool, this->pool_, this->pool_used_);
+}
+
+bool AuthIndex::restore(const AuthIndexSnapshot &snapshot) {
+    if (snapshot.count > AUTH_INDEX_CAPACITY || snapshot.pool_used > AUTH_NAME_POOL_SIZE) {
+        return false;
+    }
+    if (snapshot.pool_used > 0 && snapshot.pool[snapshot.pool_used - 1] != '\0') {
+        return false;
+    }
+    for (size_t i = 0; i < snapshot.count; i++) {
+        if (snapshot.entries[i].name_offset >= snapshot.pool_used) {
+            return false;
+        }
+        if (i > 0 && snapshot.entries[i - 1].auth_id >= snapshot.entries[i].auth_id) {
+            return false;
+        }
+    }
+
+    this->clear();
+    if (snapshot.count == 0) {
+        return true;
+    }
+    if (!this->allocate_()) {
+        return false;
+    }
+
+    memcpy(this->entries_, snapshot.entries, snapshot.count * sizeof(AuthIndexEntry));
+    memcpy(this->pool_, snapshot.pool, snapshot.pool_used);
+    this->count_ = snapshot.count;
+    this->pool_used_ = snapshot.pool_used;
+    return true;
+}
+
+bool AuthIndex::allocate_() {
+    if (this->entries_ != nullptr) {
+        return true;
+    }
+
+    // Prefers PSRAM, falls back to internal RAM
+    RAMAllocator<AuthIndexEntry> entry_allocator;
+    RAMAllocator<char> pool_allocator;
+    this->entries_ = entry_allocator.allocate(AUTH_INDEX_CAPACITY);
+    this->pool_ = pool_allocator.allocate(AUTH_NAME_POOL_SIZE);
+
+    if (this->entries_ == nullptr || this->pool_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate auth index");
+        if (this->entries_ != nullptr) {
+            entry_allocator.deallocate(this->entries_, AUTH_INDEX_CAPACITY);
+            this->entries_ = nullptr;
+        }
+        if (this->pool_ != nullptr) {
+            pool_allocator.deallocate(this->pool_, AUTH_NAME_POOL_SIZE);
+            this->pool_ = nullptr;
+        }
+        return false;
+    }
+    return true;
+}
+
+size_t AuthIndex::lower_bound_(uint32_t auth_id) const {
+    size_t low = 0;
+    size_t high = this->count_;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (this->entries_[mid].auth_id < auth_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+bool AuthIndex::intern_(const char *name, uint16_t *offset) {
+    for (size_t i = 0; i < this->count_; i++) {
+        if (strcmp(this->pool_ + this->entries_[i].name_offset, name) == 0) {
+            *offset = this->entries_[i].name_offset;
+            return true;
+        }
+    }
+
+    const size_t length = strlen(name) + 1;
+    if (this->pool_used_ + length > AUTH_NAME_POOL_SIZE) {
+        // Renamed and removed users leave unreferenced names behind
+        this->compact_pool_();
+        if (this->pool_used_ + length > AUTH_NAME_POOL_SIZE) {
+            return false;
+        }
+    }
+
+    memcpy(this->pool_ + this->pool_used_, name, length);
+    *offset = this->pool_used_;
+    this->pool_used_ += length;
+    return true;
+}
+
+void AuthIndex::compact_pool_() {
+    if (this->count_ == 0) {
+        this->pool_used_ = 0;
+        return;
+    }
+
+    // Move names to the front in pool order, entries sharing a name share the new offset
+    std::vector<uint16_t> order(this->count_);
+    for (size_t i = 0; i < this->count_; i++) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](uint16_t a, uint16_t b) {
+        return this->entries_[a].name_offset < this->entries_[b].name_offset;
+    });
+
+    size_t used = 0;
+    uint16_t previous_offset = 0;
+    uint16_t previous_new_offset = 0;
+    bool has_previous = false;
+
+    for (uint16_t i : order) {
+        AuthIndexEntry &entry = this->entries_[i];
+        if (has_previous && entry.name_offset == previous_offset) {
+            entry.name_offset = previous_new_offset;
+            continue;
+        }
+
+        const size_t length = strlen(this->pool_ + entry.name_offset) + 1;
+        memmove(this->pool_ + used, this->pool_ + entry.name_offset, length);
+
+        previous_offset = entry.name_offset;
+        previous_new_offset = used;
+        has_previous = true;
+
+        entry.name_offset = used;
+        used += length;
+    }
+
+    this->pool_used_ = used;
+}
+
+} //namespace nuki_lock
+} //namespace esphome
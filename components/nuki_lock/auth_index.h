@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace nuki_lock {
+
+static const uint16_t AUTH_INDEX_CAPACITY = 160;
+static const uint16_t AUTH_NAME_POOL_SIZE = 2048;
+
+struct AuthIndexEntry
+{
+    uint32_t auth_id;
+    uint16_t name_offset;
+    // Set while refreshing, entries not seen again are removed by finish_refresh()
+    uint8_t seen;
+    uint8_t reserved;
+};
+
+// Raw copy of the index, used to persist it
+struct AuthIndexSnapshot
+{
+    uint16_t count;
+    uint16_t pool_used;
+    AuthIndexEntry entries[AUTH_INDEX_CAPACITY];
+    char pool[AUTH_NAME_POOL_SIZE];
+};
+
+/**
+ * @brief Maps authorization ids to user names.
+ *
+ * Entries are kept sorted by id for binary search lookups. Names are interned in
+ * a fixed size pool, so apps, fobs and keypad users sharing a name store it once.
+ * Storage is allocated on first use and prefers PSRAM when available.
+ *
+ * A refresh may span several pages: begin_refresh(), add() for every received
+ * entry, then finish_refresh() drops entries the lock no longer reported.
+ */
+class AuthIndex
+{
+    public:
+        const char *find(uint32_t auth_id) const;
+
+        // Inserts or updates an entry, returns false if the index or name pool is full
+        bool add(uint32_t auth_id, const char *name);
+        void clear();
+
+        void begin_refresh();
+        void finish_refresh();
+
+        size_t size() const { return this->count_; }
+        bool empty() const { return this->count_ == 0; }
+        bool is_full() const { return this->count_ >= AUTH_INDEX_CAPACITY; }
+        size_t get_pool_used() const { return this->pool_used_; }
+
+        void save(AuthIndexSnapshot *snapshot) const;
+        bool restore(const AuthIndexSnapshot &snapshot);
+
+    protected:
+        bool allocate_();
+        size_t lower_bound_(uint32_t auth_id) const;
+        bool intern_(const char *name, uint16_t *offset);
+        void compact_pool_();
+
+        AuthIndexEntry *entries_{nullptr};
+        char *pool_{nullptr};
+        size_t count_ = 0;
+        size_t pool_used_ = 0;
+};
+
+} //namespace nuki_lock
+} //namespace esphome
@@ -0,0 +1,69 @@
+#include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+
+#include "beacon_detector.h"
+
+namespace esphome {
+namespace nuki_lock {
+
+static const char *TAG = "nuki_lock.beacon";
+
+void BeaconChangeDetector::set_address(const NimBLEAddress &address) {
+    this->address_set_ = false;
+    this->address_ = address;
+    this->reset();
+    this->address_set_ = true;
+}
+
+void BeaconChangeDetector::reset() {
+    this->flag_ = false;
+    this->change_pending_ = false;
+    this->beacons_ = 0;
+    this->acknowledged_time_ = 0;
+}
+
+void BeaconChangeDetector::onResult(const NimBLEAdvertisedDevice *advertised_device) {
+    if (!this->address_set_ || advertised_device->getAddress() != this->address_) {
+        return;
+    }
+
+    this->rssi_ = static_cast<int8_t>(advertised_device->getRSSI());
+
+    if (!advertised_device->haveManufacturerData()) {
+        return;
+    }
+
+    const std::string data = advertised_device->getManufacturerData();
+    if (data.size() <= BEACON_STATE_CHANGE_BYTE) {
+        return;
+    }
+
+    const bool flag = (data[BEACON_STATE_CHANGE_BYTE] & 0x01) != 0;
+    const bool previous = this->flag_.exchange(flag);
+
+    // The first beacon with the flag set also counts, the change may have happened before boot
+    if (flag && (!previous || this->beacons_ == 0)) {
+        this->change_pending_ = true;
+        this->changes_++;
+    }
+
+    this->beacons_++;
+}
+
+bool BeaconChangeDetector::has_change() const {
+    if (this->change_pending_) {
+        return true;
+    }
+
+    // The flag should be cleared once the state was read, if it stays set we might have missed a change
+    return this->flag_ && millis() - this->acknowledged_time_ > BEACON_CHANGE_STALE_MILLIS;
+}
+
+void BeaconChangeDetector::acknowledge() {
+    this->change_pending_ = false;
+    this->acknowledged_time_ = millis();
+    ESP_LOGV(TAG, "State change acknowledged (flag %s, rssi %d)", YESNO(this->flag_.load()), this->rssi_.load());
+}
+
+} //namespace nuki_lock
+} //namespace esphome
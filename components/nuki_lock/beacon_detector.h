@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "BleScanner.h"
+
+namespace esphome {
+namespace nuki_lock {
+
+// Byte of the Nuki beacon whose lowest bit signals a state change
+static const uint8_t BEACON_STATE_CHANGE_BYTE = 24;
+
+// A flag that stays set this long after a status query is treated as a new change
+static const uint32_t BEACON_CHANGE_STALE_MILLIS = 10000;
+
+/**
+ * @brief Watches the advertisements of the paired lock for state changes.
+ *
+ * The lock keeps its state-change flag set in every beacon until the state was
+ * read. Only a rising edge of the flag (or a flag that stays set for too long
+ * after the last query) is reported as a change, so repeated beacons of the same
+ * change do not cause additional status queries. Also caches the last RSSI.
+ *
+ * onResult() runs in the BLE scanner context, everything else on the main loop.
+ */
+class BeaconChangeDetector : public BleScanner::Subscriber
+{
+    public:
+        void set_address(const NimBLEAddress &address);
+        void reset();
+        void clear() { this->address_set_ = false; this->reset(); }
+        bool is_valid() const { return this->beacons_.load() > 0; }
+
+        void onResult(const NimBLEAdvertisedDevice *advertised_device) override;
+
+        // True if the lock advertised a state change that was not queried yet
+        bool has_change() const;
+        // Call when the status is queried
+        void acknowledge();
+
+        int8_t get_rssi() const { return this->rssi_.load(); }
+        uint32_t get_beacons() const { return this->beacons_.load(); }
+        uint32_t get_changes() const { return this->changes_.load(); }
+
+    protected:
+        NimBLEAddress address_;
+        std::atomic<bool> address_set_{false};
+
+        std::atomic<bool> flag_{false};
+        std::atomic<bool> change_pending_{false};
+        std::atomic<int8_t> rssi_{0};
+        std::atomic<uint32_t> beacons_{0};
+        std::atomic<uint32_t> changes_{0};
+
+        uint32_t acknowledged_time_ = 0;
+};
+
+} //namespace nuki_lock
+} //namespace esphome
@@ -0,0 +1,248 @@
+#include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/application.h"
+
+#include "ble_worker.h"
+
+namespace esphome {
+namespace nuki_lock {
+
+static const char *TAG = "nuki_lock.worker";
+
+// How often the main loop feeds the watchdog while waiting for a synchronous job
+static const uint32_t BLE_WORKER_SYNC_WAIT_MILLIS = 1000;
+
+bool BleWorker::submit(BleJob *job, bool control) {
+    const size_t limit = control ? BLE_WORKER_QUEUE_SIZE : BLE_WORKER_QUEUE_SIZE - BLE_WORKER_CONTROL_SLOTS;
+    if (!this->running_ || this->in_flight_ >= limit) {
+        ESP_LOGW(TAG, "Worker queue full, dropping %s job", control ? "control" : "transaction");
+        delete job;
+        return false;
+    }
+
+    job->synchronous = false;
+    if (!this->enqueue_(job)) {
+        ESP_LOGE(TAG, "Failed to queue job");
+        delete job;
+        return false;
+    }
+
+    this->in_flight_++;
+    return true;
+}
+
+Nuki::CmdResult BleWorker::execute(std::function<Nuki::CmdResult()> &&execute) {
+    if (!this->running_) {
+        return execute();
+    }
+
+    BleJob job;
+    job.execute = std::move(execute);
+    job.synchronous = true;
+
+    if (!this->enqueue_(&job)) {
+        ESP_LOGE(TAG, "Failed to queue synchronous job");
+        return Nuki::CmdResult::Error;
+    }
+
+    this->wait_sync_();
+    return job.result;
+}
+
+size_t BleWorker::process_completions() {
+    size_t processed = 0;
+    BleJob *job = nullptr;
+
+    while (this->completions_.pop(&job)) {
+        this->in_flight_--;
+        processed++;
+
+        if (job->complete) {
+            job->complete(job->result, job->duration_millis);
+        }
+        delete job;
+    }
+
+    return processed;
+}
+
+void BleWorker::run_() {
+    while (true) {
+        BleJob *job = this->dequeue_();
+        if (job == nullptr) {
+            continue;
+        }
+
+        const uint32_t started = millis();
+        job->result = job->execute();
+        job->duration_millis = millis() - started;
+
+        if (job->synchronous) {
+            this->signal_sync_();
+            continue;
+        }
+
+        // Cannot overflow, submit() never has more jobs in flight than the queue holds
+        while (!this->completions_.push(job)) {
+            delay(1);
+        }
+    }
+}
+
+#if defined(USE_ESP32)
+
+#ifdef CONFIG_BT_NIMBLE_PINNED_TO_CORE
+static const BaseType_t BLE_WORKER_CORE = CONFIG_BT_NIMBLE_PINNED_TO_CORE;
+#else
+static const BaseType_t BLE_WORKER_CORE = tskNO_AFFINITY;
+#endif
+
+bool BleWorker::start() {
+    if (this->running_) {
+        return true;
+    }
+
+    // One extra slot for a synchronous job
+    this->commands_ = xQueueCreate(BLE_WORKER_QUEUE_SIZE + 1, sizeof(BleJob *));
+    this->sync_done_ = xSemaphoreCreateBinary();
+    if (this->commands_ == nullptr || this->sync_done_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate worker queue");
+        this->release_();
+        return false;
+    }
+
+    BaseType_t res = xTaskCreatePinnedToCore(
+        BleWorker::task_entry_, "nuki_ble", BLE_WORKER_STACK_SIZE, this, BLE_WORKER_PRIORITY, &this->task_, BLE_WORKER_CORE
+    );
+    if (res != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create worker task");
+        this->release_();
+        return false;
+    }
+
+    ESP_LOGD(TAG, "Worker task started on core %d", BLE_WORKER_CORE);
+    this->running_ = true;
+    return true;
+}
+
+// Frees what a failed start() allocated, the component then runs transactions inline
+void BleWorker::release_() {
+    if (this->commands_ != nullptr) {
+        vQueueDelete(this->commands_);
+        this->commands_ = nullptr;
+    }
+    if (this->sync_done_ != nullptr) {
+        vSemaphoreDelete(this->sync_done_);
+        this->sync_done_ = nullptr;
+    }
+    this->task_ = nullptr;
+}
+
+void BleWorker::task_entry_(void *arg) {
+    static_cast<BleWorker *>(arg)->run_();
+}
+
+bool BleWorker::enqueue_(BleJob *job) {
+    return xQueueSend(this->commands_, &job, 0) == pdTRUE;
+}
+
+BleJob *BleWorker::dequeue_() {
+    BleJob *job = nullptr;
+    if (xQueueReceive(this->commands_, &job, portMAX_DELAY) != pdTRUE) {
+        return nullptr;
+    }
+    return job;
+}
+
+void BleWorker::signal_sync_() {
+    xSemaphoreGive(this->sync_done_);
+}
+
+void BleWorker::wait_sync_() {
+    while (xSemaphoreTake(this->sync_done_, pdMS_TO_TICKS(BLE_WORKER_SYNC_WAIT_MILLIS)) != pdTRUE) {
+        App.feed_wdt();
+    }
+}
+
+#elif defined(USE_HOST)
+
+bool BleWorker::start() {
+    if (this->running_) {
+        return true;
+    }
+
+    if (pthread_create(&this->thread_, nullptr, BleWorker::thread_entry_, this) != 0) {
+        ESP_LOGE(TAG, "Failed to create worker thread");
+        return false;
+    }
+
+    pthread_detach(this->thread_);
+    this->running_ = true;
+    return true;
+}
+
+void *BleWorker::thread_entry_(void *arg) {
+    static_cast<BleWorker *>(arg)->run_();
+    return nullptr;
+}
+
+bool BleWorker::enqueue_(BleJob *job) {
+    pthread_mutex_lock(&this->mutex_);
+    this->commands_.push_back(job);
+    pthread_cond_signal(&this->commands_available_);
+    pthread_mutex_unlock(&this->mutex_);
+    return true;
+}
+
+BleJob *BleWorker::dequeue_() {
+    pthread_mutex_lock(&this->mutex_);
+    while (this->commands_.empty()) {
+        pthread_cond_wait(&this->commands_available_, &this->mutex_);
+    }
+    BleJob *job = this->commands_.front();
+    this->commands_.pop_front();
+    pthread_mutex_unlock(&this->mutex_);
+    return job;
+}
+
+void BleWorker::signal_sync_() {
+    pthread_mutex_lock(&this->mutex_);
+    this->sync_finished_ = true;
+    pthread_cond_signal(&this->sync_done_);
+    pthread_mutex_unlock(&this->mutex_);
+}
+
+void BleWorker::wait_sync_() {
+    pthread_mutex_lock(&this->mutex_);
+    while (!this->sync_finished_) {
+        pthread_cond_wait(&this->sync_done_, &this->mutex_);
+    }
+    this->sync_finished_ = false;
+    pthread_mutex_unlock(&this->mutex_);
+}
+
+#else
+
+// No threading available, jobs run inline on the caller
+
+bool BleWorker::start() {
+    ESP_LOGW(TAG, "Worker task not supported on this platform");
+    return false;
+}
+
+bool BleWorker::enqueue_(BleJob *job) {
+    return false;
+}
+
+BleJob *BleWorker::dequeue_() {
+    return nullptr;
+}
+
+void BleWorker::signal_sync_() {}
+
+void BleWorker::wait_sync_() {}
+
+#endif
+
+} //namespace nuki_lock
+} //namespace esphome
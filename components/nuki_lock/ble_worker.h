@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "NukiConstants.h"
+
+#if defined(USE_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#elif defined(USE_HOST)
+#include <pthread.h>
+#include <deque>
+#endif
+
+namespace esphome {
+namespace nuki_lock {
+
+static const size_t BLE_WORKER_QUEUE_SIZE = 8;
+// Slots only control jobs may use, so a disconnect is never refused behind queued transactions
+static const size_t BLE_WORKER_CONTROL_SLOTS = 2;
+static const uint32_t BLE_WORKER_STACK_SIZE = 8192;
+static const uint8_t BLE_WORKER_PRIORITY = 5;
+
+struct BleJob
+{
+    // Runs on the worker, performs the blocking BLE transaction
+    std::function<Nuki::CmdResult()> execute;
+    // Runs on the main loop once the transaction finished
+    std::function<void(Nuki::CmdResult result, uint32_t duration_millis)> complete;
+
+    Nuki::CmdResult result = Nuki::CmdResult::Error;
+    uint32_t duration_millis = 0;
+    bool synchronous = false;
+};
+
+/**
+ * @brief Bounded single producer / single consumer queue without locks.
+ *
+ * Only one thread may push and only one thread may pop.
+ */
+template<typename T, size_t N>
+class SpscQueue
+{
+    public:
+        bool push(const T &item) {
+            const size_t head = this->head_.load(std::memory_order_relaxed);
+            const size_t next = (head + 1) % (N + 1);
+            if (next == this->tail_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            this->items_[head] = item;
+            this->head_.store(next, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(T *item) {
+            const size_t tail = this->tail_.load(std::memory_order_relaxed);
+            if (tail == this->head_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            *item = this->items_[tail];
+            this->tail_.store((tail + 1) % (N + 1), std::memory_order_release);
+            return true;
+        }
+
+    protected:
+        std::atomic<size_t> head_{0};
+        std::atomic<size_t> tail_{0};
+        T items_[N + 1];
+};
+
+/**
+ * @brief Executes blocking BLE transactions outside of the ESPHome main loop.
+ *
+ * Jobs are passed to a dedicated task (pinned to the NimBLE host core on ESP32,
+ * a pthread on host builds). Finished jobs are returned through a lock-free
+ * completion queue that the main loop drains with process_completions(), so all
+ * entity publishing stays on the main loop.
+ */
+class BleWorker
+{
+    public:
+        bool start();
+        bool is_running() const { return this->running_; }
+
+        // Queue a job, takes ownership. Returns false if the queue is full.
+        // Control jobs may also use the reserved slots.
+        bool submit(BleJob *job, bool control = false);
+
+        // Run a transaction on the worker and block the caller until it finished.
+        // Keeps the BLE stack single threaded for calls that need the result right away.
+        Nuki::CmdResult execute(std::function<Nuki::CmdResult()> &&execute);
+
+        // Runs the completion callbacks of finished jobs, call from the main loop
+        size_t process_completions();
+
+        bool is_idle() const { return this->in_flight_ == 0; }
+        size_t get_in_flight() const { return this->in_flight_; }
+
+    protected:
+        void run_();
+        bool enqueue_(BleJob *job);
+        BleJob *dequeue_();
+        void signal_sync_();
+        void wait_sync_();
+
+        #if defined(USE_ESP32)
+        static void task_entry_(void *arg);
+        void release_();
+
+        QueueHandle_t commands_{nullptr};
+        SemaphoreHandle_t sync_done_{nullptr};
+        TaskHandle_t task_{nullptr};
+        #elif defined(USE_HOST)
+        static void *thread_entry_(void *arg);
+
+        pthread_t thread_;
+        pthread_mutex_t mutex_ = PTHREAD_MUTEX_INITIALIZER;
+        pthread_cond_t commands_available_ = PTHREAD_COND_INITIALIZER;
+        pthread_cond_t sync_done_ = PTHREAD_COND_INITIALIZER;
+        std::deque<BleJob *> commands_;
+        bool sync_finished_ = false;
+        #endif
+
+        SpscQueue<BleJob *, BLE_WORKER_QUEUE_SIZE> completions_;
+        size_t in_flight_ = 0;
+        bool running_ = false;
+};
+
+} //namespace nuki_lock
+} //namespace esphome
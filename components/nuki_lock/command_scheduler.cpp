@@ -0,0 +1,176 @@
+#include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+
+#include "command_scheduler.h"
+
+namespace esphome {
+namespace nuki_lock {
+
+static const char *TAG = "nuki_lock.scheduler";
+
+void CommandScheduler::configure(CommandType type, uint8_t priority, uint32_t deadline_millis) {
+    ScheduledJob &job = this->jobs_[index(type)];
+    job.priority = priority;
+    job.deadline_millis = deadline_millis;
+}
+
+bool CommandScheduler::request(CommandType type) {
+    ScheduledJob &job = this->jobs_[index(type)];
+    job.requests++;
+
+    if (job.pending) {
+        // Keep the original request time, otherwise a steady stream of
+        // requests would keep resetting the job's age and deadline
+        job.coalesced++;
+        return false;
+    }
+
+    job.pending = true;
+    job.requested_at = millis();
+    return true;
+}
+
+void CommandScheduler::cancel(CommandType type) {
+    this->jobs_[index(type)].pending = false;
+}
+
+void CommandScheduler::clear() {
+    for (auto &job : this->jobs_) {
+        job.pending = false;
+    }
+}
+
+size_t CommandScheduler::pending_count() const {
+    size_t count = 0;
+    for (const auto &job : this->jobs_) {
+        if (job.pending) {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint32_t CommandScheduler::get_waiting_millis(CommandType type) const {
+    const ScheduledJob &job = this->jobs_[index(type)];
+    return job.pending ? millis() - job.requested_at : 0;
+}
+
+uint32_t CommandScheduler::get_effective_priority(CommandType type) const {
+    const ScheduledJob &job = this->jobs_[index(type)];
+    return job.priority + this->get_waiting_millis(type) / SCHEDULER_AGING_STEP_MILLIS;
+}
+
+bool CommandScheduler::next(CommandType *type) const {
+    const uint32_t now = millis();
+
+    int best = -1;
+    bool best_critical = false;
+    bool best_overdue = false;
+    uint32_t best_score = 0;
+
+    for (size_t i = 0; i < COMMAND_TYPE_COUNT; i++) {
+        const ScheduledJob &job = this->jobs_[i];
+        if (!job.pending) {
+            continue;
+        }
+
+        const uint32_t waiting = now - job.requested_at;
+        const bool critical = job.priority >= PRIORITY_CRITICAL;
+        const bool overdue = !critical && job.deadline_millis > 0 && waiting >= job.deadline_millis;
+
+        // Overdue jobs are ranked by how late they are, all others by aged priority
+        const uint32_t score = overdue ? waiting - job.deadline_millis : job.priority + waiting / SCHEDULER_AGING_STEP_MILLIS;
+
+        bool better = false;
+        if (best < 0) {
+            better = true;
+        } else if (critical != best_critical) {
+            better = critical;
+        } else if (overdue != best_overdue) {
+            better = overdue;
+        } else {
+            better = score > best_score;
+        }
+
+        if (better) {
+            best = i;
+            best_critical = critical;
+            best_overdue = overdue;
+            best_score = score;
+        }
+    }
+
+    if (best < 0) {
+        return false;
+    }
+
+    *type = static_cast<CommandType>(best);
+    return true;
+}
+
+void CommandScheduler::start(CommandType type) {
+    ScheduledJob &job = this->jobs_[index(type)];
+    if (!job.pending) {
+        return;
+    }
+
+    const uint32_t waiting = millis() - job.requested_at;
+
+    job.pending = false;
+    job.executed++;
+    job.last_wait_millis = waiting;
+    if (waiting > job.max_wait_millis) {
+        job.max_wait_millis = waiting;
+    }
+
+    if (job.deadline_millis > 0 && job.priority < PRIORITY_CRITICAL && waiting > job.deadline_millis) {
+        job.deadline_misses++;
+        ESP_LOGD(TAG, "%s started %ums after its deadline", command_type_to_string(type), waiting - job.deadline_millis);
+    }
+
+    ESP_LOGV(TAG, "Starting %s after %ums (%u pending)", command_type_to_string(type), waiting, this->pending_count());
+}
+
+void CommandScheduler::dump_config() const {
+    ESP_LOGCONFIG(TAG, "  Command Scheduler:");
+    for (size_t i = 0; i < COMMAND_TYPE_COUNT; i++) {
+        const ScheduledJob &job = this->jobs_[i];
+        ESP_LOGCONFIG(TAG, "    %s: priority %u, deadline %ums, pending %s, requests %u (coalesced %u), executed %u, max wait %ums, deadline misses %u",
+            command_type_to_string(static_cast<CommandType>(i)),
+            job.priority,
+            job.deadline_millis,
+            YESNO(job.pending),
+            job.requests,
+            job.coalesced,
+            job.executed,
+            job.max_wait_millis,
+            job.deadline_misses
+        );
+    }
+}
+
+const char *CommandScheduler::command_type_to_string(CommandType type) {
+    switch (type) {
+        case CommandType::LockAction:
+            return "Lock Action";
+        case CommandType::Status:
+            return "Status";
+        case CommandType::Config:
+            return "Config";
+        case CommandType::AdvancedConfig:
+            return "Advanced Config";
+        case CommandType::AuthData:
+            return "Auth Data";
+        case CommandType::EventLog:
+            return "Event Log";
+        case CommandType::KeypadData:
+            return "Keypad Data";
+        case CommandType::KeypadWrite:
+            return "Keypad Write";
+        default:
+            return "Unknown";
+    }
+}
+
+} //namespace nuki_lock
+} //namespace esphome
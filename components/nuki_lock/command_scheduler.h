@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace nuki_lock {
+
+enum class CommandType : uint8_t
+{
+    LockAction = 0,
+    Status,
+    Config,
+    AdvancedConfig,
+    AuthData,
+    EventLog,
+    KeypadData,
+    KeypadWrite,
+    Count
+};
+
+static const size_t COMMAND_TYPE_COUNT = static_cast<size_t>(CommandType::Count);
+
+// Jobs at or above this priority always run before anything else
+static const uint8_t PRIORITY_CRITICAL = 100;
+
+// A waiting job gains one priority level per aging step
+static const uint32_t SCHEDULER_AGING_STEP_MILLIS = 2000;
+
+struct ScheduledJob
+{
+    bool pending = false;
+    uint8_t priority = 0;
+    uint32_t deadline_millis = 0;
+    uint32_t requested_at = 0;
+
+    // Statistics
+    uint32_t requests = 0;
+    uint32_t coalesced = 0;
+    uint32_t executed = 0;
+    uint32_t deadline_misses = 0;
+    uint32_t last_wait_millis = 0;
+    uint32_t max_wait_millis = 0;
+};
+
+/**
+ * @brief Picks the next BLE command to run.
+ *
+ * Critical jobs (lock actions) always run first. Jobs waiting longer than their
+ * deadline are forced next, most overdue first. Everything else is ordered by its
+ * base priority plus an aging bonus, so low priority refreshes cannot starve.
+ * Requesting a job that is already pending is coalesced into the pending request.
+ */
+class CommandScheduler
+{
+    public:
+        void configure(CommandType type, uint8_t priority, uint32_t deadline_millis);
+
+        // Returns false if the request was coalesced into an already pending job
+        bool request(CommandType type);
+        void cancel(CommandType type);
+        void clear();
+
+        // Selects the job to run next without removing it
+        bool next(CommandType *type) const;
+        // Removes the job from the queue, call right before executing it
+        void start(CommandType type);
+
+        bool is_pending(CommandType type) const { return this->jobs_[index(type)].pending; }
+        bool has_pending() const { return this->pending_count() > 0; }
+        size_t pending_count() const;
+        uint32_t get_waiting_millis(CommandType type) const;
+        uint32_t get_effective_priority(CommandType type) const;
+        const ScheduledJob &get_job(CommandType type) const { return this->jobs_[index(type)]; }
+
+        void dump_config() const;
+        static const char *command_type_to_string(CommandType type);
+
+    protected:
+        static size_t index(CommandType type) { return static_cast<size_t>(type); }
+
+        ScheduledJob jobs_[COMMAND_TYPE_COUNT];
+};
+
+} //namespace nuki_lock
+} //namespace esphome
@@ -0,0 +1,74 @@
+#include "esphome/core/log.h"
+
+#include "command_trace.h"
+
+namespace esphome {
+namespace nuki_lock {
+
+static const char *TAG = "nuki_lock.trace";
+
+void CommandTrace::record(TraceCall call, uint32_t started, uint32_t duration_millis, int8_t result) {
+    TraceRecord &record = this->records_[this->count_ % COMMAND_TRACE_SIZE];
+    record.timestamp = started;
+    record.duration_millis = duration_millis > UINT16_MAX ? UINT16_MAX : duration_millis;
+    record.call = call;
+    record.result = result;
+    this->count_++;
+}
+
+void CommandTrace::clear() {
+    this->count_ = 0;
+}
+
+void CommandTrace::dump() const {
+    const size_t size = this->size();
+    const uint32_t first = this->count_ - size;
+
+    ESP_LOGI(TAG, "Command trace: %u records (%u total)", size, this->count_);
+    ESP_LOGI(TAG, "trace,timestamp,call,result,duration");
+
+    for (uint32_t i = first; i < this->count_; i++) {
+        const TraceRecord &record = this->records_[i % COMMAND_TRACE_SIZE];
+        ESP_LOGI(TAG, "trace,%u,%s,%d,%u", record.timestamp, call_to_string(record.call), record.result, record.duration_millis);
+    }
+}
+
+const char *CommandTrace::call_to_string(TraceCall call) {
+    switch (call) {
+        case TraceCall::LockAction:
+            return "lock_action";
+        case TraceCall::Status:
+            return "status";
+        case TraceCall::Config:
+            return "config";
+        case TraceCall::AdvancedConfig:
+            return "advanced_config";
+        case TraceCall::AuthData:
+            return "auth_data";
+        case TraceCall::EventLog:
+            return "event_log";
+        case TraceCall::KeypadData:
+            return "keypad_data";
+        case TraceCall::KeypadWrite:
+            return "keypad_write";
+        case TraceCall::VerifyPin:
+            return "verify_pin";
+        case TraceCall::Pair:
+            return "pair";
+        case TraceCall::Unpair:
+            return "unpair";
+        case TraceCall::Calibration:
+            return "calibration";
+        case TraceCall::Keypad:
+            return "keypad";
+        case TraceCall::ConfigWrite:
+            return "config_write";
+        case TraceCall::Event:
+            return "event";
+        default:
+            return "unknown";
+    }
+}
+
+} //namespace nuki_lock
+} //namespace esphome
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "command_scheduler.h"
+
+namespace esphome {
+namespace nuki_lock {
+
+static const size_t COMMAND_TRACE_SIZE = 128;
+
+// The first values match CommandType
+enum class TraceCall : uint8_t
+{
+    LockAction = 0,
+    Status,
+    Config,
+    AdvancedConfig,
+    AuthData,
+    EventLog,
+    KeypadData,
+    KeypadWrite,
+    VerifyPin,
+    Pair,
+    Unpair,
+    Calibration,
+    Keypad,
+    ConfigWrite,
+    // Notification from the lock library, result holds the event type
+    Event
+};
+
+#define TRACE_CALL_MATCHES(name) \
+    static_assert(static_cast<uint8_t>(TraceCall::name) == static_cast<uint8_t>(CommandType::name), \
+                  "TraceCall::" #name " must match CommandType::" #name)
+TRACE_CALL_MATCHES(LockAction);
+TRACE_CALL_MATCHES(Status);
+TRACE_CALL_MATCHES(Config);
+TRACE_CALL_MATCHES(AdvancedConfig);
+TRACE_CALL_MATCHES(AuthData);
+TRACE_CALL_MATCHES(EventLog);
+TRACE_CALL_MATCHES(KeypadData);
+TRACE_CALL_MATCHES(KeypadWrite);
+#undef TRACE_CALL_MATCHES
+static_assert(static_cast<uint8_t>(TraceCall::VerifyPin) == COMMAND_TYPE_COUNT,
+              "Every CommandType needs a TraceCall before the calls outside of the scheduler");
+
+inline TraceCall to_trace_call(CommandType command) { return static_cast<TraceCall>(command); }
+
+struct TraceRecord
+{
+    uint32_t timestamp;
+    uint16_t duration_millis;
+    TraceCall call;
+    int8_t result;
+} __attribute__((packed));
+
+/**
+ * @brief Ring buffer of the last BLE transactions and lock events.
+ *
+ * 8 bytes per record, the oldest record is overwritten when full.
+ * dump() logs one CSV line per record for offline analysis.
+ */
+class CommandTrace
+{
+    public:
+        void record(TraceCall call, uint32_t started, uint32_t duration_millis, int8_t result);
+        void clear();
+        void dump() const;
+
+        size_t size() const { return this->count_ < COMMAND_TRACE_SIZE ? this->count_ : COMMAND_TRACE_SIZE; }
+        uint32_t get_count() const { return this->count_; }
+
+        static const char *call_to_string(TraceCall call);
+
+    protected:
+        TraceRecord records_[COMMAND_TRACE_SIZE];
+        uint32_t count_ = 0;
+};
+
+} //namespace nuki_lock
+} //namespace esphome
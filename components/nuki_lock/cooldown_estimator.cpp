@@ -0,0 +1,85 @@
+#include "esphome/core/log.h"
+
+#include "cooldown_estimator.h"
+
+namespace esphome {
+namespace nuki_lock {
+
+static const char *TAG = "nuki_lock.cooldown";
+
+static const uint32_t COOLDOWN_FLOOR_MILLIS = 250;
+static const uint32_t COOLDOWN_CEILING_MILLIS = 1000;
+static const uint32_t COOLDOWN_ACTION_FLOOR_MILLIS = 1000;
+static const uint32_t COOLDOWN_ACTION_CEILING_MILLIS = 3000;
+
+// Weight of a new sample in the moving average
+static const float COOLDOWN_SMOOTHING = 0.25f;
+
+void CooldownEstimator::record(LockModel model, CommandType type, uint32_t latency_millis) {
+    CooldownStats &stats = this->stats_[static_cast<size_t>(model)][static_cast<size_t>(type)];
+
+    if (stats.samples == 0) {
+        stats.latency_millis = latency_millis;
+    } else {
+        stats.latency_millis += COOLDOWN_SMOOTHING * (static_cast<float>(latency_millis) - stats.latency_millis);
+    }
+
+    stats.samples++;
+    stats.last_latency_millis = latency_millis;
+
+    ESP_LOGV(TAG, "%s took %ums (average %.0fms, %u samples)", CommandScheduler::command_type_to_string(type), latency_millis, stats.latency_millis, stats.samples);
+}
+
+uint32_t CooldownEstimator::get_cooldown(LockModel model, CommandType type, bool success) const {
+    const uint32_t ceiling = get_ceiling(type);
+    const CooldownStats &stats = this->get_stats(model, type);
+
+    if (!success) {
+        // Failed actions did not turn the key, use the regular cooldown
+        return type == CommandType::LockAction ? COOLDOWN_CEILING_MILLIS : ceiling;
+    }
+
+    if (stats.samples < COOLDOWN_MIN_SAMPLES) {
+        return ceiling;
+    }
+
+    const uint32_t floor = get_floor(type);
+    const uint32_t learned = static_cast<uint32_t>(stats.latency_millis * COOLDOWN_LATENCY_FACTOR);
+
+    if (learned < floor) {
+        return floor;
+    }
+    if (learned > ceiling) {
+        return ceiling;
+    }
+    return learned;
+}
+
+uint32_t CooldownEstimator::get_latency(LockModel model, CommandType type) const {
+    return static_cast<uint32_t>(this->get_stats(model, type).latency_millis);
+}
+
+uint32_t CooldownEstimator::get_floor(CommandType type) {
+    return type == CommandType::LockAction ? COOLDOWN_ACTION_FLOOR_MILLIS : COOLDOWN_FLOOR_MILLIS;
+}
+
+uint32_t CooldownEstimator::get_ceiling(CommandType type) {
+    return type == CommandType::LockAction ? COOLDOWN_ACTION_CEILING_MILLIS : COOLDOWN_CEILING_MILLIS;
+}
+
+void CooldownEstimator::dump_config(LockModel model) const {
+    ESP_LOGCONFIG(TAG, "  Learned Cooldowns (%s):", model == LockModel::Ultra ? "Ultra / Go / 5th Gen" : "1st - 4th Gen");
+    for (size_t i = 0; i < COMMAND_TYPE_COUNT; i++) {
+        const CommandType type = static_cast<CommandType>(i);
+        const CooldownStats &stats = this->get_stats(model, type);
+        ESP_LOGCONFIG(TAG, "    %s: latency %ums, cooldown %ums (%u samples)",
+            CommandScheduler::command_type_to_string(type),
+            this->get_latency(model, type),
+            this->get_cooldown(model, type, true),
+            stats.samples
+        );
+    }
+}
+
+} //namespace nuki_lock
+} //namespace esphome
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "command_scheduler.h"
+
+namespace esphome {
+namespace nuki_lock {
+
+enum class LockModel : uint8_t
+{
+    Gen1To4 = 0,
+    Ultra = 1,
+    Count
+};
+
+static const size_t LOCK_MODEL_COUNT = static_cast<size_t>(LockModel::Count);
+
+// Number of successful samples before the learned cooldown replaces the default
+static const uint8_t COOLDOWN_MIN_SAMPLES = 3;
+
+// Learned cooldown = smoothed command latency * factor (clamped to floor / ceiling)
+static const float COOLDOWN_LATENCY_FACTOR = 1.5f;
+
+struct CooldownStats
+{
+    float latency_millis = 0;
+    uint32_t samples = 0;
+    uint32_t last_latency_millis = 0;
+};
+
+/**
+ * @brief Learns how long the lock needs per command type and lock model.
+ *
+ * The completion latency of every successful command is smoothed with an
+ * exponential moving average. The gap before the next command is derived
+ * from it and clamped between a safe floor and the former fixed cooldown.
+ * Until enough samples are collected (and after failures), the ceiling is used.
+ */
+class CooldownEstimator
+{
+    public:
+        void record(LockModel model, CommandType type, uint32_t latency_millis);
+
+        uint32_t get_cooldown(LockModel model, CommandType type, bool success) const;
+        uint32_t get_latency(LockModel model, CommandType type) const;
+        const CooldownStats &get_stats(LockModel model, CommandType type) const { return this->stats_[static_cast<size_t>(model)][static_cast<size_t>(type)]; }
+
+        static uint32_t get_floor(CommandType type);
+        static uint32_t get_ceiling(CommandType type);
+
+        void dump_config(LockModel model) const;
+
+    protected:
+        CooldownStats stats_[LOCK_MODEL_COUNT][COMMAND_TYPE_COUNT];
+};
+
+} //namespace nuki_lock
+} //namespace esphome
@@ -0,0 +1,73 @@
+#include <cstdio>
+#include <cstring>
+
+#include "esphome/core/log.h"
+
+#include "event_payload.h"
+
+namespace esphome {
+namespace nuki_lock {
+
+static const char *TAG = "nuki_lock.event";
+
+void EventPayload::clear() {
+    this->count_ = 0;
+    this->used_ = 0;
+}
+
+bool EventPayload::add(const char *key, const char *value) {
+    const size_t length = strlen(value) + 1;
+    if (this->used_ + length > EVENT_PAYLOAD_ARENA_SIZE) {
+        ESP_LOGW(TAG, "No space left for %s", key);
+        return false;
+    }
+
+    size_t index = this->count_;
+    for (size_t i = 0; i < this->count_; i++) {
+        if (strcmp(this->keys_[i], key) == 0) {
+            index = i;
+            break;
+        }
+    }
+
+    if (index == EVENT_PAYLOAD_MAX_ENTRIES) {
+        ESP_LOGW(TAG, "Too many entries, dropping %s", key);
+        return false;
+    }
+
+    memcpy(this->arena_ + this->used_, value, length);
+    this->keys_[index] = key;
+    this->values_[index] = this->used_;
+    this->used_ += length;
+
+    if (index == this->count_) {
+        this->count_++;
+    }
+    return true;
+}
+
+bool EventPayload::add(const char *key, uint32_t value) {
+    char buffer[11];
+    snprintf(buffer, sizeof(buffer), "%u", value);
+    return this->add(key, buffer);
+}
+
+const char *EventPayload::find(const char *key) const {
+    for (size_t i = 0; i < this->count_; i++) {
+        if (strcmp(this->keys_[i], key) == 0) {
+            return this->arena_ + this->values_[i];
+        }
+    }
+    return nullptr;
+}
+
+std::map<std::string, std::string> EventPayload::to_map() const {
+    std::map<std::string, std::string> data;
+    for (size_t i = 0; i < this->count_; i++) {
+        data.emplace(this->keys_[i], this->arena_ + this->values_[i]);
+    }
+    return data;
+}
+
+} //namespace nuki_lock
+} //namespace esphome
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace esphome {
+namespace nuki_lock {
+
+static const uint8_t EVENT_PAYLOAD_MAX_ENTRIES = 16;
+static const size_t EVENT_PAYLOAD_ARENA_SIZE = 256;
+
+/**
+ * @brief Fixed capacity key/value list for Home Assistant event data.
+ *
+ * Keys must be string literals, values are copied into an internal arena.
+ * Nothing is allocated until the payload is converted with to_map() right
+ * before it is sent.
+ */
+class EventPayload
+{
+    public:
+        void clear();
+
+        // Adds the entry or replaces the value of an existing key, returns false if full
+        bool add(const char *key, const char *value);
+        bool add(const char *key, uint32_t value);
+
+        const char *find(const char *key) const;
+        size_t size() const { return this->count_; }
+
+        std::map<std::string, std::string> to_map() const;
+
+    protected:
+        const char *keys_[EVENT_PAYLOAD_MAX_ENTRIES];
+        uint16_t values_[EVENT_PAYLOAD_MAX_ENTRIES];
+        char arena_[EVENT_PAYLOAD_ARENA_SIZE];
+        size_t count_ = 0;
+        size_t used_ = 0;
+};
+
+} //namespace nuki_lock
+} //namespace esphome
@@ -0,0 +1,155 @@
+#include <cstring>
+
+#include "esphome/core/log.h"
+#include "esphome/core/helpers.h"
+
+#include "keypad_cache.h"
+
+namespace esphome {
+namespace nuki_lock {
+
+static const char *TAG = "nuki_lock.keypad";
+
+const KeypadCacheEntry *KeypadCache::find(uint16_t code_id) const {
+    const size_t i = this->lower_bound_(code_id);
+    if (i < this->count_ && this->entries_[i].code_id == code_id) {
+        return &this->entries_[i];
+    }
+    return nullptr;
+}
+
+const KeypadCacheEntry *KeypadCache::find_by_name(const char *name) const {
+    for (size_t i = 0; i < this->count_; i++) {
+        if (strcmp(this->entries_[i].name, name) == 0) {
+            return &this->entries_[i];
+        }
+    }
+    return nullptr;
+}
+
+bool KeypadCache::update(uint16_t code_id, const char *name, uint32_t code, bool enabled) {
+    if (!this->allocate_()) {
+        return false;
+    }
+
+    const size_t i = this->lower_bound_(code_id);
+    if (i >= this->count_ || this->entries_[i].code_id != code_id) {
+        if (this->is_full()) {
+            ESP_LOGW(TAG, "Cache full, ignoring keypad code %u", code_id);
+            return false;
+        }
+
+        memmove(&this->entries_[i + 1], &this->entries_[i], (this->count_ - i) * sizeof(KeypadCacheEntry));
+        this->entries_[i].code_id = code_id;
+        this->count_++;
+    }
+
+    KeypadCacheEntry &entry = this->entries_[i];
+    entry.enabled = enabled ? 1 : 0;
+    entry.seen = 1;
+    entry.code = code;
+    strncpy(entry.name, name, KEYPAD_NAME_LEN);
+    entry.name[KEYPAD_NAME_LEN] = '\0';
+    return true;
+}
+
+bool KeypadCache::remove(uint16_t code_id) {
+    const size_t i = this->lower_bound_(code_id);
+    if (i >= this->count_ || this->entries_[i].code_id != code_id) {
+        return false;
+    }
+
+    memmove(&this->entries_[i], &this->entries_[i + 1], (this->count_ - i - 1) * sizeof(KeypadCacheEntry));
+    this->count_--;
+    return true;
+}
+
+void KeypadCache::clear() {
+    this->count_ = 0;
+    this->valid_ = false;
+}
+
+void KeypadCache::begin_refresh() {
+    for (size_t i = 0; i < this->count_; i++) {
+        this->entries_[i].seen = 0;
+    }
+}
+
+void KeypadCache::finish_refresh() {
+    size_t kept = 0;
+    for (size_t i = 0; i < this->count_; i++) {
+        if (this->entries_[i].seen) {
+            this->entries_[kept++] = this->entries_[i];
+        }
+    }
+    this->count_ = kept;
+    this->valid_ = true;
+
+    ESP_LOGD(TAG, "Keypad cache holds %u codes", this->count_);
+}
+
+void KeypadCache::save(KeypadCacheSnapshot *snapshot) const {
+    snapshot->count = this->count_;
+    snapshot->valid = this->valid_ ? 1 : 0;
+    if (this->count_ > 0) {
+        memcpy(snapshot->entries, this->entries_, this->count_ * sizeof(KeypadCacheEntry));
+    }
+}
+
+bool KeypadCache::restore(const KeypadCacheSnapshot &snapshot) {
+    if (snapshot.count > KEYPAD_CACHE_CAPACITY) {
+        return false;
+    }
+    for (size_t i = 1; i < snapshot.count; i++) {
+        if (snapshot.entries[i - 1].code_id >= snapshot.entries[i].code_id) {
+            return false;
+        }
+    }
+
+    this->clear();
+    if (snapshot.count > 0) {
+        if (!this->allocate_()) {
+            return false;
+        }
+        memcpy(this->entries_, snapshot.entries, snapshot.count * sizeof(KeypadCacheEntry));
+        for (size_t i = 0; i < snapshot.count; i++) {
+            this->entries_[i].name[KEYPAD_NAME_LEN] = '\0';
+        }
+    }
+
+    this->count_ = snapshot.count;
+    this->valid_ = snapshot.valid != 0;
+    return true;
+}
+
+bool KeypadCache::allocate_() {
+    if (this->entries_ != nullptr) {
+        return true;
+    }
+
+    // Prefers PSRAM, falls back to internal RAM
+    RAMAllocator<KeypadCacheEntry> allocator;
+    this->entries_ = allocator.allocate(KEYPAD_CACHE_CAPACITY);
+    if (this->entries_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate keypad cache");
+        return false;
+    }
+    return true;
+}
+
+size_t KeypadCache::lower_bound_(uint16_t code_id) const {
+    size_t low = 0;
+    size_t high = this->count_;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (this->entries_[mid].code_id < code_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+} //namespace nuki_lock
+} //namespace esphome
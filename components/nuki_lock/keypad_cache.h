@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace nuki_lock {
+
+static const uint16_t KEYPAD_CACHE_CAPACITY = 100;
+static const uint8_t KEYPAD_NAME_LEN = 20;
+
+struct KeypadCacheEntry
+{
+    uint16_t code_id;
+    uint8_t enabled;
+    // Set while refreshing, entries not seen again are removed by finish_refresh()
+    uint8_t seen;
+    uint32_t code;
+    char name[KEYPAD_NAME_LEN + 1];
+};
+
+// Raw copy of the cache, used to persist it
+struct KeypadCacheSnapshot
+{
+    uint16_t count;
+    uint8_t valid;
+    KeypadCacheEntry entries[KEYPAD_CACHE_CAPACITY];
+};
+
+/**
+ * @brief Local copy of the keypad codes, sorted by code id.
+ *
+ * Filled page by page from retrieveKeypadEntries and kept up to date after
+ * successful add, update and delete commands, so ids can be validated and
+ * resolved to names without BLE traffic. Storage is allocated on first use
+ * and prefers PSRAM when available.
+ */
+class KeypadCache
+{
+    public:
+        const KeypadCacheEntry *find(uint16_t code_id) const;
+        const KeypadCacheEntry *find_by_name(const char *name) const;
+        const KeypadCacheEntry &get(size_t index) const { return this->entries_[index]; }
+
+        // Inserts or updates an entry, returns false if the cache is full
+        bool update(uint16_t code_id, const char *name, uint32_t code, bool enabled);
+        bool remove(uint16_t code_id);
+        void clear();
+
+        void begin_refresh();
+        void finish_refresh();
+
+        // True once the cache was completely filled from the lock
+        bool is_valid() const { return this->valid_; }
+        size_t size() const { return this->count_; }
+        bool is_full() const { return this->count_ >= KEYPAD_CACHE_CAPACITY; }
+
+        void save(KeypadCacheSnapshot *snapshot) const;
+        bool restore(const KeypadCacheSnapshot &snapshot);
+
+    protected:
+        bool allocate_();
+        size_t lower_bound_(uint16_t code_id) const;
+
+        KeypadCacheEntry *entries_{nullptr};
+        size_t count_ = 0;
+        bool valid_ = false;
+};
+
+} //namespace nuki_lock
+} //namespace esphome
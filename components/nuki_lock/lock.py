@@ -20,6 +20,9 @@ from esphome.const import (
     UNIT_DEGREES,
     UNIT_PERCENT,
     UNIT_DECIBEL_MILLIWATT,
+    UNIT_MILLISECOND,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
 )
 import esphome.final_validate as fv
 
@@ -34,6 +37,13 @@ CONF_DOOR_SENSOR_BINARY_SENSOR = "door_sensor"
 
 CONF_BATTERY_LEVEL_SENSOR = "battery_level"
 CONF_BT_SIGNAL_SENSOR = "bt_signal_strength"
+CONF_STATUS_COOLDOWN_SENSOR = "status_cooldown"
+CONF_LOCK_ACTION_COOLDOWN_SENSOR = "lock_action_cooldown"
+CONF_LOCK_ACTION_DELAY_SENSOR = "lock_action_delay"
+CONF_CONNECTS_SAVED_SENSOR = "connects_saved"
+CONF_LOCK_ACTION_LATENCY_SENSOR = "lock_action_latency"
+CONF_STATUS_QUERIES_AVOIDED_SENSOR = "status_queries_avoided"
+CONF_BLE_COMMANDS_SENSOR = "ble_commands"
 
 CONF_DOOR_SENSOR_STATE_TEXT_SENSOR = "door_sensor_state"
 CONF_LAST_UNLOCK_USER_TEXT_SENSOR = "last_unlock_user"
@@ -177,6 +187,16 @@ CONF_QUERY_INTERVAL_CONFIG = "query_interval_config"
 CONF_QUERY_INTERVAL_AUTH_DATA = "query_interval_auth_data"
 CONF_BLE_GENERAL_TIMEOUT = "ble_general_timeout"
 CONF_BLE_COMMAND_TIMEOUT = "ble_command_timeout"
+CONF_ASYNC_COMMANDS = "async_commands"
+CONF_EVENT_DRIVEN = "event_driven"
+CONF_TRANSITION_POLL_INTERVAL = "transition_poll_interval"
+CONF_TRANSITION_POLL_BACKOFF = "transition_poll_backoff"
+CONF_TRANSITION_POLL_MAX = "transition_poll_max"
+CONF_KEYPAD_CODES = "keypad_codes"
+CONF_KEYPAD_CODES_EXCLUSIVE = "keypad_codes_exclusive"
+CONF_KEYPAD_CODE_NAME = "name"
+CONF_KEYPAD_CODE = "code"
+CONF_KEYPAD_CODE_ENABLED = "enabled"
 CONF_EVENT = "event"
 
 CONF_ON_PAIRING_MODE_ON = "on_pairing_mode_on_action"
@@ -268,6 +288,36 @@ PairingModeOffTrigger = nuki_lock_ns.class_("PairingModeOffTrigger", automation.
 PairedTrigger = nuki_lock_ns.class_("PairedTrigger", automation.Trigger.template())
 EventLogReceivedTrigger = nuki_lock_ns.class_("EventLogReceivedTrigger", automation.Trigger.template())
 
+def validate_keypad_name(value):
+    value = cv.string_strict(value)
+    if value in ("", "--") or len(value) > 20:
+        raise cv.Invalid("Keypad name must have 1 to 20 characters and must not be '--'")
+    return value
+
+
+def validate_keypad_code(value):
+    value = cv.int_(value)
+    if not 100000 < value < 1000000 or "0" in str(value):
+        raise cv.Invalid("Keypad code must be 6 digits, without 0")
+    return value
+
+
+def validate_unique_keypad_names(value):
+    names = [code[CONF_KEYPAD_CODE_NAME] for code in value]
+    duplicates = sorted({name for name in names if names.count(name) > 1})
+    if duplicates:
+        raise cv.Invalid(f"Keypad names must be unique, duplicates: {', '.join(duplicates)}")
+    return value
+
+
+KEYPAD_CODE_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_KEYPAD_CODE_NAME): validate_keypad_name,
+        cv.Required(CONF_KEYPAD_CODE): validate_keypad_code,
+        cv.Optional(CONF_KEYPAD_CODE_ENABLED, default=True): cv.boolean,
+    }
+)
+
 CONFIG_SCHEMA = cv.All(
     lock.lock_schema(NukiLockComponent).extend(
         {
@@ -322,6 +372,52 @@ CONFIG_SCHEMA = cv.All(
                 unit_of_measurement=UNIT_DECIBEL_MILLIWATT,
                 icon="mdi:bluetooth-audio"
             ),
+            cv.Optional(CONF_STATUS_COOLDOWN_SENSOR): sensor.sensor_schema(
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                state_class=STATE_CLASS_MEASUREMENT,
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=0,
+                icon="mdi:timer-sand"
+            ),
+            cv.Optional(CONF_LOCK_ACTION_COOLDOWN_SENSOR): sensor.sensor_schema(
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                state_class=STATE_CLASS_MEASUREMENT,
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=0,
+                icon="mdi:timer-lock"
+            ),
+            cv.Optional(CONF_LOCK_ACTION_DELAY_SENSOR): sensor.sensor_schema(
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                state_class=STATE_CLASS_MEASUREMENT,
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=0,
+                icon="mdi:timer-alert"
+            ),
+            cv.Optional(CONF_CONNECTS_SAVED_SENSOR): sensor.sensor_schema(
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                accuracy_decimals=0,
+                icon="mdi:bluetooth-connect"
+            ),
+            cv.Optional(CONF_LOCK_ACTION_LATENCY_SENSOR): sensor.sensor_schema(
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                state_class=STATE_CLASS_MEASUREMENT,
+                unit_of_measurement=UNIT_MILLISECOND,
+                accuracy_decimals=0,
+                icon="mdi:timer-check"
+            ),
+            cv.Optional(CONF_STATUS_QUERIES_AVOIDED_SENSOR): sensor.sensor_schema(
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                accuracy_decimals=0,
+                icon="mdi:sync-off"
+            ),
+            cv.Optional(CONF_BLE_COMMANDS_SENSOR): sensor.sensor_schema(
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                accuracy_decimals=0,
+                icon="mdi:bluetooth-transfer"
+            ),
             cv.Optional(CONF_UNPAIR_BUTTON): button.button_schema(
                 NukiLockUnpairButton,
                 entity_category=ENTITY_CATEGORY_CONFIG,
@@ -543,9 +639,18 @@ CONFIG_SCHEMA = cv.All(
             cv.Optional(CONF_EVENT, default="none"): cv.string,
             cv.Optional(CONF_SECURITY_PIN, default="0"): cv.templatable(cv.uint32_t),
             cv.Optional(CONF_QUERY_INTERVAL_CONFIG, default="3600s"): cv.positive_time_period_seconds,
-            cv.Optional(CONF_QUERY_INTERVAL_AUTH_DATA, default="3600s"): cv.positive_time_period_seconds,
+            cv.Optional(CONF_QUERY_INTERVAL_AUTH_DATA, default="86400s"): cv.positive_time_period_seconds,
             cv.Optional(CONF_BLE_GENERAL_TIMEOUT, default="3s"): cv.positive_time_period_seconds,
             cv.Optional(CONF_BLE_COMMAND_TIMEOUT, default="3s"): cv.positive_time_period_seconds,
+            cv.Optional(CONF_ASYNC_COMMANDS, default=False): cv.boolean,
+            cv.Optional(CONF_EVENT_DRIVEN, default=False): cv.boolean,
+            cv.Optional(CONF_TRANSITION_POLL_INTERVAL, default="250ms"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_TRANSITION_POLL_BACKOFF, default=1.5): cv.float_range(min=1.0, max=4.0),
+            cv.Optional(CONF_TRANSITION_POLL_MAX, default=8): cv.int_range(min=0, max=50),
+            cv.Optional(CONF_KEYPAD_CODES): cv.All(
+                cv.ensure_list(KEYPAD_CODE_SCHEMA), cv.Length(max=100), validate_unique_keypad_names
+            ),
+            cv.Optional(CONF_KEYPAD_CODES_EXCLUSIVE, default=False): cv.boolean,
             cv.Optional(CONF_ON_PAIRING_MODE_ON): automation.validate_automation(
                 {
                     cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(PairingModeOnTrigger),
@@ -603,6 +708,32 @@ async def to_code(config):
     if CONF_BLE_COMMAND_TIMEOUT in config:
         cg.add(var.set_ble_command_timeout(config[CONF_BLE_COMMAND_TIMEOUT]))
 
+    if CONF_ASYNC_COMMANDS in config:
+        cg.add(var.set_async_commands(config[CONF_ASYNC_COMMANDS]))
+
+    if CONF_EVENT_DRIVEN in config:
+        cg.add(var.set_event_driven(config[CONF_EVENT_DRIVEN]))
+
+    if CONF_TRANSITION_POLL_INTERVAL in config:
+        cg.add(var.set_transition_poll_interval(config[CONF_TRANSITION_POLL_INTERVAL]))
+
+    if CONF_TRANSITION_POLL_BACKOFF in config:
+        cg.add(var.set_transition_poll_backoff(config[CONF_TRANSITION_POLL_BACKOFF]))
+
+    if CONF_TRANSITION_POLL_MAX in config:
+        cg.add(var.set_transition_poll_max(config[CONF_TRANSITION_POLL_MAX]))
+
+    if CONF_KEYPAD_CODES in config:
+        for keypad_code in config[CONF_KEYPAD_CODES]:
+            cg.add(var.add_keypad_code(
+                keypad_code[CONF_KEYPAD_CODE_NAME],
+                keypad_code[CONF_KEYPAD_CODE],
+                keypad_code[CONF_KEYPAD_CODE_ENABLED]
+            ))
+
+    if CONF_KEYPAD_CODES_EXCLUSIVE in config:
+        cg.add(var.set_keypad_codes_exclusive(config[CONF_KEYPAD_CODES_EXCLUSIVE]))
+
     # Binary Sensor
     if connected := config.get(CONF_CONNECTED_BINARY_SENSOR):
         sens = await binary_sensor.new_binary_sensor(connected)
@@ -629,6 +760,34 @@ async def to_code(config):
         sens = await sensor.new_sensor(bt_signal)
         cg.add(var.set_bt_signal_sensor(sens))
 
+    if status_cooldown := config.get(CONF_STATUS_COOLDOWN_SENSOR):
+        sens = await sensor.new_sensor(status_cooldown)
+        cg.add(var.set_status_cooldown_sensor(sens))
+
+    if lock_action_cooldown := config.get(CONF_LOCK_ACTION_COOLDOWN_SENSOR):
+        sens = await sensor.new_sensor(lock_action_cooldown)
+        cg.add(var.set_lock_action_cooldown_sensor(sens))
+
+    if lock_action_delay := config.get(CONF_LOCK_ACTION_DELAY_SENSOR):
+        sens = await sensor.new_sensor(lock_action_delay)
+        cg.add(var.set_lock_action_delay_sensor(sens))
+
+    if connects_saved := config.get(CONF_CONNECTS_SAVED_SENSOR):
+        sens = await sensor.new_sensor(connects_saved)
+        cg.add(var.set_connects_saved_sensor(sens))
+
+    if lock_action_latency := config.get(CONF_LOCK_ACTION_LATENCY_SENSOR):
+        sens = await sensor.new_sensor(lock_action_latency)
+        cg.add(var.set_lock_action_latency_sensor(sens))
+
+    if status_queries_avoided := config.get(CONF_STATUS_QUERIES_AVOIDED_SENSOR):
+        sens = await sensor.new_sensor(status_queries_avoided)
+        cg.add(var.set_status_queries_avoided_sensor(sens))
+
+    if ble_commands := config.get(CONF_BLE_COMMANDS_SENSOR):
+        sens = await sensor.new_sensor(ble_commands)
+        cg.add(var.set_ble_commands_sensor(sens))
+
     # Text Sensor
     if door_sensor_state := config.get(CONF_DOOR_SENSOR_STATE_TEXT_SENSOR):
         sens = await text_sensor.new_text_sensor(door_sensor_state)
@@ -906,6 +1065,22 @@ async def to_code(config):
         trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
         await automation.build_automation(trigger, [(LogEntry, "x")], conf)
 
+    # Libraries and NimBLE settings, other platforms (e.g. host) have to provide
+    # NukiBleEsp32 compatible NukiLock and BleScanner implementations
+    if CORE.is_esp32:
+        _add_esp32_libraries()
+
+    # Defines
+    cg.add_define("NUKI_NO_WDT_RESET")
+
+    # Build flags
+    cg.add_build_flag("-Wno-unused-result")
+    cg.add_build_flag("-Wno-ignored-qualifiers")
+    cg.add_build_flag("-Wno-missing-field-initializers")
+    cg.add_build_flag("-Wno-maybe-uninitialized")
+
+
+def _add_esp32_libraries():
     # Libraries
     add_idf_component(
         name="espressif/libsodium",
@@ -948,15 +1123,6 @@ async def to_code(config):
     #add_idf_sdkconfig_option("CONFIG_BT_NIMBLE_LOG_LEVEL", 4)
     #add_idf_sdkconfig_option("CONFIG_BT_NIMBLE_LOG_LEVEL_DEBUG", True)
 
-    # Defines
-    cg.add_define("NUKI_NO_WDT_RESET")
-
-    # Build flags
-    cg.add_build_flag("-Wno-unused-result")
-    cg.add_build_flag("-Wno-ignored-qualifiers")
-    cg.add_build_flag("-Wno-missing-field-initializers")
-    cg.add_build_flag("-Wno-maybe-uninitialized")
-
 
 def _final_validate(config):
     full_config = fv.full_config.get()
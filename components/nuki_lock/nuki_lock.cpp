@@ -6,14 +6,146 @@
 #include "esphome/components/api/custom_api_device.h"
 #endif
 
-#include <map>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+
+#ifdef USE_ESP32
+#include <esp_task_wdt.h>
+#endif
 
 #include "nuki_lock.h"
 
 namespace esphome {
 namespace nuki_lock {
 
+static const char *TAG = "nuki_lock.lock";
+
 uint32_t global_nuki_lock_id = 1912044075ULL;
+uint32_t global_nuki_lock_cache_id = 1912044076ULL;
+
+/*
+ * Setting tables, indexed by ConfigSwitch, ConfigNumber and ConfigSelect. The config key
+ * matches the entity member name, e.g. auto_lock_enabled and auto_lock_enabled_switch_.
+ */
+#ifdef USE_SWITCH
+#define CONFIG_SWITCH(name, label, model, field) \
+    {#name, label, ConfigModel::model, false, &NukiLockComponent::name##_switch_, \
+        [](const NukiLock::Config &config) -> bool { return config.field; }, \
+        [](NukiLock::Config &config, bool value) { config.field = value; }, \
+        nullptr, nullptr}
+#define ADVANCED_CONFIG_SWITCH(name, label, model, field) \
+    {#name, label, ConfigModel::model, true, &NukiLockComponent::name##_switch_, nullptr, nullptr, \
+        [](const NukiLock::AdvancedConfig &advanced_config) -> bool { return advanced_config.field; }, \
+        [](NukiLock::AdvancedConfig &advanced_config, bool value) { advanced_config.field = value; }}
+
+const ConfigSwitchDescriptor NukiLockComponent::CONFIG_SWITCHES[] = {
+    CONFIG_SWITCH(pairing_enabled, "Pairing Enabled", Any, pairingEnabled),
+    CONFIG_SWITCH(auto_unlatch_enabled, "Auto Unlatch Enabled", Any, autoUnlatch),
+    CONFIG_SWITCH(button_enabled, "Button Enabled", Any, buttonEnabled),
+    CONFIG_SWITCH(led_enabled, "LED Enabled", Any, ledEnabled),
+    ADVANCED_CONFIG_SWITCH(nightmode_enabled, "Night Mode Enabled", Any, nightModeEnabled),
+    ADVANCED_CONFIG_SWITCH(night_mode_auto_lock_enabled, "Night Mode Auto Lock", Any, nightModeAutoLockEnabled),
+    ADVANCED_CONFIG_SWITCH(night_mode_auto_unlock_disabled, "Night Mode Auto Unlock Disabled", Any, nightModeAutoUnlockDisabled),
+    ADVANCED_CONFIG_SWITCH(night_mode_immediate_lock_on_start, "Night Mode Immediate Lock On Start", Any, nightModeImmediateLockOnStart),
+    ADVANCED_CONFIG_SWITCH(auto_lock_enabled, "Auto Lock", Any, autoLockEnabled),
+    ADVANCED_CONFIG_SWITCH(auto_unlock_disabled, "Auto Unlock Disabled", Any, autoUnLockDisabled),
+    ADVANCED_CONFIG_SWITCH(immediate_auto_lock_enabled, "Immediate Auto Lock", Any, immediateAutoLockEnabled),
+    ADVANCED_CONFIG_SWITCH(auto_update_enabled, "Automatic Updates", Any, autoUpdateEnabled),
+    CONFIG_SWITCH(single_lock_enabled, "Single Lock Enabled", Any, singleLock),
+    CONFIG_SWITCH(dst_mode_enabled, "DST Mode Enabled", Any, dstMode),
+    ADVANCED_CONFIG_SWITCH(auto_battery_type_detection_enabled, "Automatic Battery Type Detection Enabled", NonUltra, automaticBatteryTypeDetection),
+    ADVANCED_CONFIG_SWITCH(slow_speed_during_night_mode_enabled, "Slow Speed During Night Mode Enabled", Ultra, enableSlowSpeedDuringNightMode),
+    ADVANCED_CONFIG_SWITCH(detached_cylinder_enabled, "Detached Cylinder Enabled", Any, detachedCylinder),
+};
+static_assert(sizeof(NukiLockComponent::CONFIG_SWITCHES) / sizeof(ConfigSwitchDescriptor) == static_cast<size_t>(ConfigSwitch::Count),
+    "CONFIG_SWITCHES must have one entry per ConfigSwitch");
+
+#undef CONFIG_SWITCH
+#undef ADVANCED_CONFIG_SWITCH
+#endif
+
+#ifdef USE_NUMBER
+#define CONFIG_NUMBER(name, label, model, field, min_value, max_value) \
+    {#name, label, ConfigModel::model, false, &NukiLockComponent::name##_number_, min_value, max_value, \
+        [](const NukiLock::Config &config) -> float { return config.field; }, \
+        [](NukiLock::Config &config, float value) { config.field = value; }, \
+        nullptr, nullptr}
+#define ADVANCED_CONFIG_NUMBER(name, label, model, field, min_value, max_value) \
+    {#name, label, ConfigModel::model, true, &NukiLockComponent::name##_number_, min_value, max_value, nullptr, nullptr, \
+        [](const NukiLock::AdvancedConfig &advanced_config) -> float { return advanced_config.field; }, \
+        [](NukiLock::AdvancedConfig &advanced_config, float value) { advanced_config.field = value; }}
+
+const ConfigNumberDescriptor NukiLockComponent::CONFIG_NUMBERS[] = {
+    CONFIG_NUMBER(led_brightness, "LED Brightness", Any, ledBrightness, 0, 5),
+    CONFIG_NUMBER(timezone_offset, "Timezone Offset", Any, timeZoneOffset, -60, 60),
+    ADVANCED_CONFIG_NUMBER(lock_n_go_timeout, "LockNGo Timeout", Any, lockNgoTimeout, 5, 60),
+    ADVANCED_CONFIG_NUMBER(auto_lock_timeout, "Auto Lock Timeout", Any, autoLockTimeOut, 30, 1800),
+    ADVANCED_CONFIG_NUMBER(unlatch_duration, "Unlatch Duration", Any, unlatchDuration, 1, 30),
+    ADVANCED_CONFIG_NUMBER(unlocked_position_offset, "Unlocked Position Offset Degrees", Any, unlockedPositionOffsetDegrees, -90, 180),
+    ADVANCED_CONFIG_NUMBER(locked_position_offset, "Locked Position Offset Degrees", Any, lockedPositionOffsetDegrees, -180, 90),
+    ADVANCED_CONFIG_NUMBER(single_locked_position_offset, "Single Locked Position Offset Degrees", Any, singleLockedPositionOffsetDegrees, -180, 180),
+    ADVANCED_CONFIG_NUMBER(unlocked_to_locked_transition_offset, "Unlocked To Locked Transition Offset Degrees", Any, unlockedToLockedTransitionOffsetDegrees, -180, 180),
+};
+static_assert(sizeof(NukiLockComponent::CONFIG_NUMBERS) / sizeof(ConfigNumberDescriptor) == static_cast<size_t>(ConfigNumber::Count),
+    "CONFIG_NUMBERS must have one entry per ConfigNumber");
+
+#undef CONFIG_NUMBER
+#undef ADVANCED_CONFIG_NUMBER
+#endif
+
+#ifdef USE_SELECT
+#define SELECT_CONVERSION(type, to_enum, to_string_function) \
+        [](NukiLockComponent *parent, const char *option) -> int { return static_cast<int>(parent->to_enum(option)); }, \
+        [](NukiLockComponent *parent, int value, char *str) { parent->to_string_function(static_cast<type>(value), str); }
+#define CONFIG_SELECT(name, label, model, field, type, to_enum, to_string_function) \
+    {#name, label, ConfigModel::model, false, &NukiLockComponent::name##_select_, \
+        SELECT_CONVERSION(type, to_enum, to_string_function), \
+        [](const NukiLock::Config &config) -> int { return static_cast<int>(config.field); }, \
+        [](NukiLock::Config &config, int value) { config.field = static_cast<type>(value); }, \
+        nullptr, nullptr}
+#define ADVANCED_CONFIG_SELECT(name, label, model, field, type, to_enum, to_string_function) \
+    {#name, label, ConfigModel::model, true, &NukiLockComponent::name##_select_, \
+        SELECT_CONVERSION(type, to_enum, to_string_function), nullptr, nullptr, \
+        [](const NukiLock::AdvancedConfig &advanced_config) -> int { return static_cast<int>(advanced_config.field); }, \
+        [](NukiLock::AdvancedConfig &advanced_config, int value) { advanced_config.field = static_cast<type>(value); }}
+// fob_action_to_int() returns 99 for unknown options
+#define FOB_ACTION_SELECT(number) \
+    {"fob_action_" #number, "Fob Action " #number, ConfigModel::Any, false, &NukiLockComponent::fob_action_##number##_select_, \
+        [](NukiLockComponent *parent, const char *option) -> int { \
+            const uint8_t action = parent->fob_action_to_int(option); \
+            return action == 99 ? -1 : action; \
+        }, \
+        [](NukiLockComponent *parent, int value, char *str) { parent->fob_action_to_string(value, str); }, \
+        [](const NukiLock::Config &config) -> int { return config.fobAction##number; }, \
+        [](NukiLock::Config &config, int value) { config.fobAction##number = value; }, \
+        nullptr, nullptr}
+
+const ConfigSelectDescriptor NukiLockComponent::CONFIG_SELECTS[] = {
+    ADVANCED_CONFIG_SELECT(single_button_press_action, "Single Button Press Action", Any, singleButtonPressAction,
+        NukiLock::ButtonPressAction, button_press_action_to_enum, button_press_action_to_string),
+    ADVANCED_CONFIG_SELECT(double_button_press_action, "Double Button Press Action", Any, doubleButtonPressAction,
+        NukiLock::ButtonPressAction, button_press_action_to_enum, button_press_action_to_string),
+    FOB_ACTION_SELECT(1),
+    FOB_ACTION_SELECT(2),
+    FOB_ACTION_SELECT(3),
+    CONFIG_SELECT(timezone, "Timezone", Any, timeZoneId,
+        Nuki::TimeZoneId, timezone_to_enum, timezone_to_string),
+    CONFIG_SELECT(advertising_mode, "Advertising Mode", Any, advertisingMode,
+        Nuki::AdvertisingMode, advertising_mode_to_enum, advertising_mode_to_string),
+    ADVANCED_CONFIG_SELECT(battery_type, "Battery Type", NonUltra, batteryType,
+        Nuki::BatteryType, battery_type_to_enum, battery_type_to_string),
+    ADVANCED_CONFIG_SELECT(motor_speed, "Motor Speed", Ultra, motorSpeed,
+        NukiLock::MotorSpeed, motor_speed_to_enum, motor_speed_to_string),
+};
+static_assert(sizeof(NukiLockComponent::CONFIG_SELECTS) / sizeof(ConfigSelectDescriptor) == static_cast<size_t>(ConfigSelect::Count),
+    "CONFIG_SELECTS must have one entry per ConfigSelect");
+
+#undef SELECT_CONVERSION
+#undef CONFIG_SELECT
+#undef ADVANCED_CONFIG_SELECT
+#undef FOB_ACTION_SELECT
+#endif
 
 lock::LockState NukiLockComponent::nuki_to_lock_state(NukiLock::LockState nukiLockState) {
     switch(nukiLockState) {
@@ -519,15 +651,62 @@ void NukiLockComponent::save_settings() {
     }
 }
 
-void NukiLockComponent::update_status() {
-    this->status_update_ = false;
+void NukiLockComponent::load_cache() {
+    // Too large for the loop task stack
+    std::unique_ptr<NukiLockCache> cache(new NukiLockCache());
+    if (!this->cache_pref_.load(cache.get()) || cache->version != CACHE_VERSION) {
+        ESP_LOGD(TAG, "No cached event log cursor and auth data");
+        return;
+    }
 
-    char str[50] = {0};
+    this->last_rolling_log_id = cache->last_rolling_log_id;
+    if (!this->auth_index_.restore(cache->auth_index)) {
+        ESP_LOGW(TAG, "Discarding invalid cached auth data");
+    }
+    if (!this->keypad_cache_.restore(cache->keypad)) {
+        ESP_LOGW(TAG, "Discarding invalid cached keypad codes");
+    }
 
-    Nuki::CmdResult cmd_result = this->nuki_lock_.requestKeyTurnerState(&(this->retrieved_key_turner_state_));
-    NukiLock::cmdResultToString(cmd_result, str);
+    ESP_LOGD(TAG, "Restored event log cursor %u, %u auth entries and %u keypad codes",
+        this->last_rolling_log_id, this->auth_index_.size(), this->keypad_cache_.size());
+}
 
-    App.feed_wdt();
+void NukiLockComponent::save_cache() {
+    if (!this->cache_dirty_) {
+        return;
+    }
+    this->cache_dirty_ = false;
+    this->cancel_timeout("save_cache");
+
+    std::unique_ptr<NukiLockCache> cache(new NukiLockCache());
+    cache->version = CACHE_VERSION;
+    cache->last_rolling_log_id = this->last_rolling_log_id;
+    this->auth_index_.save(&cache->auth_index);
+    this->keypad_cache_.save(&cache->keypad);
+
+    if (!this->cache_pref_.save(cache.get())) {
+        ESP_LOGW(TAG, "Failed to save cache");
+    }
+}
+
+void NukiLockComponent::schedule_cache_save() {
+    // Log catch-up and auth refreshes change the cache in bursts, write once afterwards
+    if (this->cache_dirty_) {
+        return;
+    }
+    this->cache_dirty_ = true;
+    this->set_timeout("save_cache", CACHE_SAVE_DELAY_MILLIS, [this]() {
+        this->save_cache();
+    });
+}
+
+void NukiLockComponent::on_safe_shutdown() {
+    this->save_cache();
+}
+
+bool NukiLockComponent::handle_status_result(Nuki::CmdResult cmd_result) {
+    char str[50] = {0};
+    NukiLock::cmdResultToString(cmd_result, str);
 
     if (cmd_result == Nuki::CmdResult::Success) {
         ESP_LOGD(TAG, "requestKeyTurnerState has resulted in %s (%d)", str, cmd_result);
@@ -551,7 +730,10 @@ void NukiLockComponent::update_status() {
             this->retrieved_key_turner_state_.currentTimeSecond
         );
 
+        this->check_config_update_count(this->retrieved_key_turner_state_.configUpdateCount);
+
         this->publish_state(this->nuki_to_lock_state(this->retrieved_key_turner_state_.lockState));
+        this->record_action_latency(this->nuki_to_lock_state(this->retrieved_key_turner_state_.lockState));
 
         #ifdef USE_BINARY_SENSOR
         if (this->connected_binary_sensor_ != nullptr) {
@@ -612,17 +794,23 @@ void NukiLockComponent::update_status() {
         if (this->retrieved_key_turner_state_.lockState == NukiLock::LockState::Locking || 
             this->retrieved_key_turner_state_.lockState == NukiLock::LockState::Unlocking) {
             // Schedule a status update without waiting for the next advertisement because the lock
-            // is in a transition state. This will speed up the feedback.
-            this->status_update_ = true;
+            // is in a transition state. The first polls use a shorter cooldown, see update_cooldown().
+            this->scheduler_.request(CommandType::Status);
+            // Saturated, a lock stuck in a transition must not wrap around into burst polling again
+            if (this->transition_polls_ <= this->transition_poll_max_) {
+                this->transition_polls_++;
+            }
             
             if (this->send_events_) {
-                this->event_log_update_ = true;
+                this->scheduler_.request(CommandType::EventLog);
             }
+        } else {
+            this->transition_polls_ = 0;
         }
     } else {
         ESP_LOGE(TAG, "requestKeyTurnerState has resulted in %s (%d)", str, cmd_result);
 
-        this->status_update_ = true;
+        this->scheduler_.request(CommandType::Status);
         this->status_update_consecutive_errors_++;
 
         if (this->status_update_consecutive_errors_ > MAX_TOLERATED_UPDATES_ERRORS) {
@@ -638,89 +826,50 @@ void NukiLockComponent::update_status() {
             #endif
         }
     }
+
+    return cmd_result == Nuki::CmdResult::Success;
 }
 
-void NukiLockComponent::update_config() {
-    this->config_update_ = false;
+void NukiLockComponent::check_config_update_count(uint8_t config_update_count) {
+    if (this->config_update_count_valid_) {
+        bool changed = false;
+        if (config_update_count != this->config_update_count_) {
+            // The counter wraps around, our own writes account for some of the increments
+            const uint8_t updates = config_update_count - this->config_update_count_;
+            if (updates > this->own_config_updates_) {
+                ESP_LOGD(TAG, "Config was changed on the lock (%u updates), refreshing", updates);
+                this->start_session({CommandType::Config, CommandType::AdvancedConfig});
+                changed = true;
+            }
+            this->own_config_updates_ = 0;
+        }
 
-    char str[50] = {0};
+        // Nobody else changed the config since the previous status, the cache can be written back
+        this->config_checked_ = !changed;
+        this->advanced_config_checked_ = !changed;
+    }
+
+    this->config_update_count_ = config_update_count;
+    this->config_update_count_valid_ = true;
+}
 
-    NukiLock::Config config;
-    Nuki::CmdResult conf_req_result = this->nuki_lock_.requestConfig(&config);
+bool NukiLockComponent::handle_config_result(Nuki::CmdResult conf_req_result) {
+    char str[50] = {0};
     NukiLock::cmdResultToString(conf_req_result, str);
 
-    App.feed_wdt();
+    const NukiLock::Config &config = this->config_;
 
     if (conf_req_result == Nuki::CmdResult::Success) {
         ESP_LOGD(TAG, "requestConfig has resulted in %s (%d)", str, conf_req_result);
+        this->config_valid_ = true;
+        this->config_checked_ = false;
 
         keypad_paired_ = config.hasKeypad || config.hasKeypadV2;
-
-        #ifdef USE_SWITCH
-        if (this->pairing_enabled_switch_ != nullptr) {
-            this->pairing_enabled_switch_->publish_state(config.pairingEnabled);
+        if (keypad_paired_ && (!this->keypad_cache_.is_valid() || this->keypad_sync_pending_) && this->pin_state_ == PinState::Valid) {
+            this->request_keypad_data(true);
         }
 
-        if (this->auto_unlatch_enabled_switch_ != nullptr) {
-            this->auto_unlatch_enabled_switch_->publish_state(config.autoUnlatch);
-        }
-        
-        if (this->button_enabled_switch_ != nullptr) {
-            this->button_enabled_switch_->publish_state(config.buttonEnabled);
-        }
-        
-        if (this->led_enabled_switch_ != nullptr) {
-            this->led_enabled_switch_->publish_state(config.ledEnabled);
-        }
-        
-        if (this->single_lock_enabled_switch_ != nullptr) {
-            this->single_lock_enabled_switch_->publish_state(config.singleLock);
-        }
-        
-        if (this->dst_mode_enabled_switch_ != nullptr) {
-            this->dst_mode_enabled_switch_->publish_state(config.dstMode);
-        }
-        #endif
-        #ifdef USE_NUMBER
-        if (this->led_brightness_number_ != nullptr) {
-            this->led_brightness_number_->publish_state(config.ledBrightness);
-        }
-        
-        if (this->timezone_offset_number_ != nullptr) {
-            this->timezone_offset_number_->publish_state(config.timeZoneOffset);
-        }
-        #endif
-        #ifdef USE_SELECT
-        if (this->fob_action_1_select_ != nullptr) {
-            memset(str, 0, sizeof(str));
-            this->fob_action_to_string(config.fobAction1, str);
-            this->fob_action_1_select_->publish_state(str);
-        }
-        
-        if (this->fob_action_2_select_ != nullptr) {
-            memset(str, 0, sizeof(str));
-            this->fob_action_to_string(config.fobAction2, str);
-            this->fob_action_2_select_->publish_state(str);
-        }
-        
-        if (this->fob_action_3_select_ != nullptr) {
-            memset(str, 0, sizeof(str));
-            this->fob_action_to_string(config.fobAction3, str);
-            this->fob_action_3_select_->publish_state(str);
-        }
-        
-        if (this->timezone_select_ != nullptr) {
-            memset(str, 0, sizeof(str));
-            this->timezone_to_string(config.timeZoneId, str);
-            this->timezone_select_->publish_state(str);
-        }
-        
-        if (this->advertising_mode_select_ != nullptr) {
-            memset(str, 0, sizeof(str));
-            this->advertising_mode_to_string(config.advertisingMode, str);
-            this->advertising_mode_select_->publish_state(str);
-        }
-        #endif
+        this->publish_config_settings(false);
         
         ESP_LOGD(TAG, "Device Type: %i", (config.deviceType == 255 ? 0 : config.deviceType));
         ESP_LOGD(TAG, "Product Variant: %i", (config.productVariant == 255 ? 0 : config.productVariant));
@@ -737,231 +886,217 @@ void NukiLockComponent::update_config() {
         ESP_LOGD(TAG, "Homekit Status: %s", str);
     } else {
         ESP_LOGE(TAG, "requestConfig has resulted in %s (%d)", str, conf_req_result);
-        this->config_update_ = true;
+        this->config_valid_ = false;
+        this->scheduler_.request(CommandType::Config);
     }
-}
 
-void NukiLockComponent::update_advanced_config() {
-    this->advanced_config_update_ = false;
+    return conf_req_result == Nuki::CmdResult::Success;
+}
 
+bool NukiLockComponent::handle_advanced_config_result(Nuki::CmdResult conf_req_result) {
     char str[50] = {0};
-
-    NukiLock::AdvancedConfig advanced_config;
-    Nuki::CmdResult conf_req_result = this->nuki_lock_.requestAdvancedConfig(&advanced_config);
     NukiLock::cmdResultToString(conf_req_result, str);
 
-    App.feed_wdt();
-
     if (conf_req_result == Nuki::CmdResult::Success) {
         ESP_LOGD(TAG, "requestAdvancedConfig has resulted in %s (%d)", str, conf_req_result);
+        this->advanced_config_valid_ = true;
+        this->advanced_config_checked_ = false;
 
-        #ifdef USE_SWITCH
-        if (this->nightmode_enabled_switch_ != nullptr) {
-            this->nightmode_enabled_switch_->publish_state(advanced_config.nightModeEnabled);
-        }
+        this->publish_config_settings(true);
+    } else {
+        ESP_LOGE(TAG, "requestAdvancedConfig has resulted in %s (%d)", str, conf_req_result);
+        this->advanced_config_valid_ = false;
+        this->scheduler_.request(CommandType::AdvancedConfig);
+    }
 
-        if (this->night_mode_auto_lock_enabled_switch_ != nullptr) {
-            this->night_mode_auto_lock_enabled_switch_->publish_state(advanced_config.nightModeAutoLockEnabled);
-        }
+    return conf_req_result == Nuki::CmdResult::Success;
+}
 
-        if (this->night_mode_auto_unlock_disabled_switch_ != nullptr) {
-            this->night_mode_auto_unlock_disabled_switch_->publish_state(advanced_config.nightModeAutoUnlockDisabled);
-        }
+bool NukiLockComponent::handle_auth_data_result(Nuki::CmdResult auth_data_req_result, std::list<NukiLock::AuthorizationEntry>& authEntries) {
+    char auth_data_req_result_as_string[30] = {0};
+    NukiLock::cmdResultToString(auth_data_req_result, auth_data_req_result_as_string);
 
-        if (this->night_mode_immediate_lock_on_start_switch_ != nullptr) {
-            this->night_mode_immediate_lock_on_start_switch_->publish_state(advanced_config.nightModeImmediateLockOnStart);
-        }
+    if (auth_data_req_result == Nuki::CmdResult::Success) {
+        ESP_LOGD(TAG, "retrieveAuthorizationEntries has resulted in %s (%d)", auth_data_req_result_as_string, auth_data_req_result);
+        this->process_auth_entries(authEntries);
+    } else {
+        ESP_LOGE(TAG, "retrieveAuthorizationEntries has resulted in %s (%d)", auth_data_req_result_as_string, auth_data_req_result);
+        this->scheduler_.request(CommandType::AuthData);
+    }
 
-        if (this->auto_lock_enabled_switch_ != nullptr) {
-            this->auto_lock_enabled_switch_->publish_state(advanced_config.autoLockEnabled);
-        }
+    return auth_data_req_result == Nuki::CmdResult::Success;
+}
 
-        if (this->auto_unlock_disabled_switch_ != nullptr) {
-            this->auto_unlock_disabled_switch_->publish_state(advanced_config.autoUnLockDisabled);
-        }
+void NukiLockComponent::process_auth_entries(std::list<NukiLock::AuthorizationEntry>& authEntries) {
+    App.feed_wdt();
 
-        if (this->immediate_auto_lock_enabled_switch_ != nullptr) {
-            this->immediate_auto_lock_enabled_switch_->publish_state(advanced_config.immediateAutoLockEnabled);
-        }
+    char name[MAX_NAME_LEN + 1];
 
-        if (this->auto_update_enabled_switch_ != nullptr) {
-            this->auto_update_enabled_switch_->publish_state(advanced_config.autoUpdateEnabled);
-        }
+    if (this->auth_data_probe_) {
+        // Unchanged: exactly the last known entry comes back with the same name
+        bool changed = authEntries.size() != 1;
+        for (const auto& entry : authEntries) {
+            strncpy(name, reinterpret_cast<const char*>(entry.name), MAX_NAME_LEN);
+            name[MAX_NAME_LEN] = '\0';
 
-        // Gen 1-4 only
-        if (!this->nuki_lock_.isLockUltra() && this->auto_battery_type_detection_enabled_switch_ != nullptr) {
-            this->auto_battery_type_detection_enabled_switch_->publish_state(advanced_config.automaticBatteryTypeDetection);
+            const char* known_name = this->auth_index_.find(entry.authId);
+            if (known_name == nullptr || strcmp(known_name, name) != 0) {
+                changed = true;
+            }
         }
 
-        // Ultra only
-        if (this->nuki_lock_.isLockUltra() && this->slow_speed_during_night_mode_enabled_switch_ != nullptr) {
-            this->slow_speed_during_night_mode_enabled_switch_->publish_state(advanced_config.enableSlowSpeedDuringNightMode);
+        if (changed) {
+            this->request_auth_data_refresh("probe");
+        } else {
+            ESP_LOGD(TAG, "Auth data unchanged");
         }
+        return;
+    }
 
-        if (this->detached_cylinder_enabled_switch_ != nullptr) {
-            this->detached_cylinder_enabled_switch_->publish_state(advanced_config.detachedCylinder);
-        }
-        #endif
+    if (authEntries.empty() && this->auth_data_offset_ == 0) {
+        ESP_LOGW(TAG, "No auth entries!");
+        return;
+    }
 
-        #ifdef USE_NUMBER
-        if (this->lock_n_go_timeout_number_ != nullptr) {
-            this->lock_n_go_timeout_number_->publish_state(advanced_config.lockNgoTimeout);
-        }
-        if (this->auto_lock_timeout_number_ != nullptr) {
-            this->auto_lock_timeout_number_->publish_state(advanced_config.autoLockTimeOut);
-        }
-        if (this->unlatch_duration_number_ != nullptr) {
-            this->unlatch_duration_number_->publish_state(advanced_config.unlatchDuration);
-        }
-        if (this->unlocked_position_offset_number_ != nullptr) {
-            this->unlocked_position_offset_number_->publish_state(advanced_config.unlockedPositionOffsetDegrees);
-        }
-        if (this->locked_position_offset_number_ != nullptr) {
-            this->locked_position_offset_number_->publish_state(advanced_config.lockedPositionOffsetDegrees);
-        }
-        if (this->single_locked_position_offset_number_ != nullptr) {
-            this->single_locked_position_offset_number_->publish_state(advanced_config.singleLockedPositionOffsetDegrees);
-        }
-        if (this->unlocked_to_locked_transition_offset_number_ != nullptr) {
-            this->unlocked_to_locked_transition_offset_number_->publish_state(advanced_config.unlockedToLockedTransitionOffsetDegrees);
-        }
-        #endif
+    ESP_LOGD(TAG, "Authorization Entry Count: %d", authEntries.size());
 
-        #ifdef USE_SELECT
-        if (this->single_button_press_action_select_ != nullptr) {
-            memset(str, 0, sizeof(str));
-            this->button_press_action_to_string(advanced_config.singleButtonPressAction, str);
-            this->single_button_press_action_select_->publish_state(str);
-        }
+    if (this->auth_data_offset_ == 0) {
+        this->auth_index_.begin_refresh();
+    }
 
-        if (this->double_button_press_action_select_ != nullptr) {
-            memset(str, 0, sizeof(str));
-            this->button_press_action_to_string(advanced_config.doubleButtonPressAction, str);
-            this->double_button_press_action_select_->publish_state(str);
-        }
+    for (const auto& entry : authEntries) {
+        strncpy(name, reinterpret_cast<const char*>(entry.name), MAX_NAME_LEN);
+        name[MAX_NAME_LEN] = '\0';
 
-        // Gen 1-4 only
-        if (!this->nuki_lock_.isLockUltra() && this->battery_type_select_ != nullptr) {
-            memset(str, 0, sizeof(str));
-            this->battery_type_to_string(advanced_config.batteryType, str);
-            this->battery_type_select_->publish_state(str);
-        }
+        ESP_LOGD(TAG, "Authorization entry[%d] type: %d name: %s", entry.authId, entry.idType, name);
+        this->auth_index_.add(entry.authId, name);
+    }
 
-        // Ultra
-        if (this->nuki_lock_.isLockUltra() && this->motor_speed_select_ != nullptr) {
-            memset(str, 0, sizeof(str));
-            this->motor_speed_to_string(advanced_config.motorSpeed, str);
-            this->motor_speed_select_->publish_state(str);
-        }
-        #endif
-    } else {
-        ESP_LOGE(TAG, "requestAdvancedConfig has resulted in %s (%d)", str, conf_req_result);
-        this->advanced_config_update_ = true;
+    // A full page means the lock may have more entries, fetch them in the next slot
+    if (authEntries.size() >= AUTH_DATA_PAGE_SIZE && !this->auth_index_.is_full()) {
+        this->auth_data_offset_ += authEntries.size();
+        this->scheduler_.request(CommandType::AuthData);
+        this->trigger_commands();
+        return;
     }
+
+    this->auth_data_offset_ = 0;
+    this->auth_index_.finish_refresh();
+    this->schedule_cache_save();
 }
 
-void NukiLockComponent::update_auth_data() {
-    this->auth_data_update_ = false;
-    this->cancel_timeout("wait_for_auth_data");
+bool NukiLockComponent::handle_keypad_data_result(Nuki::CmdResult keypad_data_req_result, const std::list<NukiLock::KeypadEntry>& entries) {
+    char keypad_data_req_result_as_string[30] = {0};
+    NukiLock::cmdResultToString(keypad_data_req_result, keypad_data_req_result_as_string);
 
-    if(this->pin_state_ != PinState::Valid) {
-        ESP_LOGW(TAG, "It seems like you did not set a valid pin!");
-        return;
+    if (keypad_data_req_result == Nuki::CmdResult::Success) {
+        ESP_LOGD(TAG, "retrieveKeypadEntries has resulted in %s (%d)", keypad_data_req_result_as_string, keypad_data_req_result);
+        this->process_keypad_entries(entries);
+    } else {
+        ESP_LOGE(TAG, "retrieveKeypadEntries has resulted in %s (%d)", keypad_data_req_result_as_string, keypad_data_req_result);
+        this->scheduler_.request(CommandType::KeypadData);
     }
 
-    Nuki::CmdResult auth_data_req_result = this->nuki_lock_.retrieveAuthorizationEntries(0, MAX_AUTH_DATA_ENTRIES);
-    char auth_data_req_result_as_string[30] = {0};
-    NukiLock::cmdResultToString(auth_data_req_result, auth_data_req_result_as_string);
+    return keypad_data_req_result == Nuki::CmdResult::Success;
+}
 
+void NukiLockComponent::process_keypad_entries(const std::list<NukiLock::KeypadEntry>& entries) {
     App.feed_wdt();
 
-    if (auth_data_req_result == Nuki::CmdResult::Success) {
-        ESP_LOGD(TAG, "retrieveAuthorizationEntries has resulted in %s (%d)", auth_data_req_result_as_string, auth_data_req_result);
-
-        this->set_timeout("wait_for_auth_data", 5000, [this]() {
+    ESP_LOGD(TAG, "Keypad Entry Count: %d", entries.size());
 
-            std::list<NukiLock::AuthorizationEntry> authEntries;
-            this->nuki_lock_.getAuthorizationEntries(&authEntries);
-    
-            if (!authEntries.empty()) {
-                ESP_LOGD(TAG, "Authorization Entry Count: %d", authEntries.size());
-
-                authEntries.sort([](const NukiLock::AuthorizationEntry& a, const NukiLock::AuthorizationEntry& b) {
-                    return a.authId < b.authId;
-                });
-        
-                if (authEntries.size() > MAX_AUTH_DATA_ENTRIES) {
-                    authEntries.resize(MAX_AUTH_DATA_ENTRIES);
-                }
+    if (this->keypad_data_full_ && this->keypad_data_offset_ == 0) {
+        this->keypad_cache_.begin_refresh();
+    }
 
-                this->auth_entries_count_ = 0;
+    const size_t known = this->keypad_cache_.size();
+    char name[KEYPAD_NAME_LEN + 1];
+    for (const auto& entry : entries) {
+        strncpy(name, reinterpret_cast<const char*>(entry.name), KEYPAD_NAME_LEN);
+        name[KEYPAD_NAME_LEN] = '\0';
+        this->keypad_cache_.update(entry.codeId, name, entry.code, entry.enabled);
+    }
 
-                for(const auto& entry : authEntries) {
-                    if (this->auth_entries_count_ >= MAX_AUTH_DATA_ENTRIES) break;
+    // A full page means the lock may have more codes, fetch them in the next slot
+    if (entries.size() >= KEYPAD_DATA_PAGE_SIZE && !this->keypad_cache_.is_full()) {
+        this->keypad_data_offset_ += entries.size();
+        this->scheduler_.request(CommandType::KeypadData);
+        this->trigger_commands();
+        return;
+    }
 
-                    AuthEntry& auth_entry = this->auth_entries_[this->auth_entries_count_];
-                    auth_entry.authId = entry.authId;
+    if (this->keypad_data_full_) {
+        this->keypad_data_full_ = false;
+        this->keypad_cache_.finish_refresh();
+    } else if (this->keypad_cache_.size() == known) {
+        // New code not found after the known ones, the lock reused an older id
+        this->request_keypad_data(true);
+        return;
+    }
 
-                    strncpy(auth_entry.name, reinterpret_cast<const char*>(entry.name), MAX_NAME_LEN - 1);
-                    auth_entry.name[MAX_NAME_LEN - 1] = '\0';
+    this->keypad_data_offset_ = 0;
+    this->schedule_cache_save();
 
-                    ESP_LOGD(TAG, "Authorization entry[%d] type: %d name: %s", entry.authId, entry.idType, entry.name);
+    if (this->keypad_print_pending_) {
+        this->keypad_print_pending_ = false;
+        this->print_keypad_cache();
+    }
 
-                    this->auth_entries_count_++;
-                }
-            } else {
-                ESP_LOGW(TAG, "No auth entries!");
-            }
-        });
-    } else {
-        ESP_LOGE(TAG, "retrieveAuthorizationEntries has resulted in %s (%d)", auth_data_req_result_as_string, auth_data_req_result);
-        this->auth_data_update_ = true;
+    if (this->keypad_sync_pending_) {
+        this->reconcile_keypad_codes();
     }
 }
 
-void NukiLockComponent::update_event_logs() {
-    this->event_log_update_ = false;
-    this->cancel_timeout("wait_for_log_entries");
+bool NukiLockComponent::handle_event_log_result(Nuki::CmdResult event_log_req_result, std::list<NukiLock::LogEntry>& log) {
+    char event_log_req_result_as_string[30] = {0};
+    NukiLock::cmdResultToString(event_log_req_result, event_log_req_result_as_string);
 
-    if(this->pin_state_ != PinState::Valid) {
-        ESP_LOGW(TAG, "It seems like you did not set a valid pin!");
-        return;
+    if (event_log_req_result == Nuki::CmdResult::Success) {
+        ESP_LOGD(TAG, "retrieveLogEntries has resulted in %s (%d)", event_log_req_result_as_string, event_log_req_result);
+        this->process_log_page(log);
+    } else {
+        ESP_LOGE(TAG, "retrieveLogEntries has resulted in %s (%d)", event_log_req_result_as_string, event_log_req_result);
+        this->scheduler_.request(CommandType::EventLog);
     }
 
-    Nuki::CmdResult event_log_req_result = this->nuki_lock_.retrieveLogEntries(0, MAX_EVENT_LOG_ENTRIES, 1, false);
-    char event_log_req_result_as_string[30] = {0};
-    NukiLock::cmdResultToString(event_log_req_result, event_log_req_result_as_string);
+    return event_log_req_result == Nuki::CmdResult::Success;
+}
 
+void NukiLockComponent::process_log_page(std::list<NukiLock::LogEntry>& log) {
     App.feed_wdt();
 
-    if (event_log_req_result == Nuki::CmdResult::Success) {
-        ESP_LOGD(TAG, "retrieveLogEntries has resulted in %s (%d)", event_log_req_result_as_string, event_log_req_result);
+    if (log.empty()) {
+        ESP_LOGD(TAG, "No new log entries");
+        return;
+    }
 
-        this->set_timeout("wait_for_log_entries", 5000, [this]() {
-            std::list<NukiLock::LogEntry> log;
-            this->nuki_lock_.getLogEntries(&log);
+    ESP_LOGD(TAG, "Log Entry Count: %d", log.size());
 
-            App.feed_wdt();
+    log.sort([](const NukiLock::LogEntry& a, const NukiLock::LogEntry& b) {
+        return a.index < b.index;
+    });
 
-            if (!log.empty()) {
-                ESP_LOGD(TAG, "Log Entry Count: %d", log.size());
+    // Entries arrive in no guaranteed order, truncate only once sorted. Without a cursor the
+    // newest entries were requested, otherwise the ones right after the cursor.
+    const size_t received = log.size();
+    if (received > this->event_log_count_) {
+        if (this->event_log_start_index_ == 0) {
+            log.erase(log.begin(), std::next(log.begin(), received - this->event_log_count_));
+        } else {
+            log.resize(this->event_log_count_);
+        }
+    }
 
-                if (log.size() > MAX_EVENT_LOG_ENTRIES) {
-                    log.resize(MAX_EVENT_LOG_ENTRIES);
-                }
-        
-                log.sort([](const NukiLock::LogEntry& a, const NukiLock::LogEntry& b) {
-                    return a.index < b.index;
-                });
+    const uint32_t cursor = this->last_rolling_log_id;
+    this->process_log_entries(log);
 
-                this->process_log_entries(log);
-            } else {
-                ESP_LOGW(TAG, "No log entries!");
-            }
-        });
-    } else {
-        ESP_LOGE(TAG, "retrieveLogEntries has resulted in %s (%d)", event_log_req_result_as_string, event_log_req_result);
-        this->event_log_update_ = true;
+    // A full page means there may be more missed entries, fetch them in the next slot.
+    // Stop if the cursor did not move to never loop on a lock ignoring the start index.
+    if (this->event_log_start_index_ != 0 && received >= this->event_log_count_ &&
+        this->last_rolling_log_id > cursor) {
+        ESP_LOGD(TAG, "Event log not caught up yet, requesting next page");
+        this->scheduler_.request(CommandType::EventLog);
+        this->trigger_commands();
     }
 }
 
@@ -969,18 +1104,14 @@ void NukiLockComponent::process_log_entries(const std::list<NukiLock::LogEntry>&
     ESP_LOGD(TAG, "Process Event Log Entries");
 
     char buffer[50] = {0};
-    char num_buffer[16];
     uint32_t auth_index = 0;
 
-    std::map<std::string, std::string> event_data;
+    EventPayload event_data;
 
     for (const auto& log : log_entries) {
-        event_data.clear();
-
         if (log.loggingType == NukiLock::LoggingType::LockAction ||
             log.loggingType == NukiLock::LoggingType::KeypadAction) {
-            
-            int sizeName = sizeof(log.name);
+
             strncpy(buffer, reinterpret_cast<const char*>(log.name), sizeof(buffer) - 1);
             buffer[sizeof(buffer) - 1] = '\0';
 
@@ -1003,89 +1134,94 @@ void NukiLockComponent::process_log_entries(const std::list<NukiLock::LogEntry>&
             }
         }
 
+        // Entries up to the cursor were already processed
+        if (log.index <= this->last_rolling_log_id) {
+            continue;
+        }
+        this->last_rolling_log_id = log.index;
+        this->schedule_cache_save();
+        this->check_auth_data_changed(log);
+
         if (this->send_events_) {
-            snprintf(num_buffer, sizeof(num_buffer), "%u", log.index);
-            event_data["index"] = num_buffer;
+            event_data.clear();
 
-            snprintf(num_buffer, sizeof(num_buffer), "%u", log.authId);
-            event_data["authorizationId"] = num_buffer;
+            event_data.add("index", log.index);
+            event_data.add("authorizationId", log.authId);
 
             const char* authName = get_auth_name(log.authId);
             if (!authName) authName = this->auth_name_;
-            event_data["authorizationName"] = authName;
-
-            snprintf(num_buffer, sizeof(num_buffer), "%u", log.timeStampYear);
-            event_data["timeYear"] = num_buffer;
-            snprintf(num_buffer, sizeof(num_buffer), "%u", log.timeStampMonth);
-            event_data["timeMonth"] = num_buffer;
-            snprintf(num_buffer, sizeof(num_buffer), "%u", log.timeStampDay);
-            event_data["timeDay"] = num_buffer;
-            snprintf(num_buffer, sizeof(num_buffer), "%u", log.timeStampHour);
-            event_data["timeHour"] = num_buffer;
-            snprintf(num_buffer, sizeof(num_buffer), "%u", log.timeStampMinute);
-            event_data["timeMinute"] = num_buffer;
-            snprintf(num_buffer, sizeof(num_buffer), "%u", log.timeStampSecond);
-            event_data["timeSecond"] = num_buffer;
+            event_data.add("authorizationName", authName);
+
+            event_data.add("timeYear", log.timeStampYear);
+            event_data.add("timeMonth", log.timeStampMonth);
+            event_data.add("timeDay", log.timeStampDay);
+            event_data.add("timeHour", log.timeStampHour);
+            event_data.add("timeMinute", log.timeStampMinute);
+            event_data.add("timeSecond", log.timeStampSecond);
 
             NukiLock::loggingTypeToString(log.loggingType, buffer);
-            event_data["type"] = buffer;
+            event_data.add("type", buffer);
 
             switch (log.loggingType) {
                 case NukiLock::LoggingType::LockAction:
                     NukiLock::lockactionToString((NukiLock::LockAction)log.data[0], buffer);
-                    event_data["action"] = buffer;
+                    event_data.add("action", buffer);
                     NukiLock::triggerToString((NukiLock::Trigger)log.data[1], buffer);
-                    event_data["trigger"] = buffer;
+                    event_data.add("trigger", buffer);
                     NukiLock::completionStatusToString((NukiLock::CompletionStatus)log.data[3], buffer);
-                    event_data["completionStatus"] = buffer;
+                    event_data.add("completionStatus", buffer);
                     break;
 
                 case NukiLock::LoggingType::KeypadAction:
                 {
                     NukiLock::lockactionToString((NukiLock::LockAction)log.data[0], buffer);
-                    event_data["action"] = buffer;
+                    event_data.add("action", buffer);
 
                     switch (log.data[1]) {
-                        case 0: event_data["trigger"] = "arrowkey"; break;
-                        case 1: event_data["trigger"] = "code"; break;
-                        case 2: event_data["trigger"] = "fingerprint"; break;
-                        default: event_data["trigger"] = "unknown"; break;
+                        case 0: event_data.add("trigger", "arrowkey"); break;
+                        case 1: event_data.add("trigger", "code"); break;
+                        case 2: event_data.add("trigger", "fingerprint"); break;
+                        default: event_data.add("trigger", "unknown"); break;
                     }
 
                     if (log.data[2] == 9)
-                        event_data["trigger"] = "notAuthorized";
+                        event_data.add("trigger", "notAuthorized");
                     else if (log.data[2] == 224)
-                        event_data["trigger"] = "invalidCode";
+                        event_data.add("trigger", "invalidCode");
                     else {
                         NukiLock::completionStatusToString((NukiLock::CompletionStatus)log.data[2], buffer);
-                        event_data["completionStatus"] = buffer;
+                        event_data.add("completionStatus", buffer);
                     }
 
                     unsigned int codeId = 256U * log.data[4] + log.data[3];
-                    snprintf(num_buffer, sizeof(num_buffer), "%u", codeId);
-                    event_data["codeId"] = num_buffer;
+                    event_data.add("codeId", codeId);
+
+                    const KeypadCacheEntry* keypad_entry = this->keypad_cache_.find(codeId);
+                    if (keypad_entry != nullptr) {
+                        event_data.add("codeName", keypad_entry->name);
+                    }
                     break;
                 }
 
                 case NukiLock::LoggingType::DoorSensor:
                     switch (log.data[0]) {
-                        case 0: event_data["action"] = "DoorOpened"; break;
-                        case 1: event_data["action"] = "DoorClosed"; break;
-                        case 2: event_data["action"] = "SensorJammed"; break;
-                        default: event_data["action"] = "Unknown"; break;
+                        case 0: event_data.add("action", "DoorOpened"); break;
+                        case 1: event_data.add("action", "DoorClosed"); break;
+                        case 2: event_data.add("action", "SensorJammed"); break;
+                        default: event_data.add("action", "Unknown"); break;
                     }
                     break;
+
+                default:
+                    break;
             }
 
-            if (log.index > this->last_rolling_log_id) {
-                this->last_rolling_log_id = log.index;
-                this->event_log_received_callback_.call(log);
+            this->event_log_received_callback_.call(log);
 
-                #ifdef USE_API_HOMEASSISTANT_SERVICES
-                ESP_LOGD(TAG, "Send event to Home Assistant on %s", this->event_);
-                this->fire_homeassistant_event(this->event_, event_data);
-                #endif
-            }
+            #ifdef USE_API_HOMEASSISTANT_SERVICES
+            ESP_LOGD(TAG, "Send event to Home Assistant on %s", this->event_);
+            this->fire_homeassistant_event(this->event_, event_data.to_map());
+            #endif
         }
     }
 
@@ -1096,54 +1232,762 @@ void NukiLockComponent::process_log_entries(const std::list<NukiLock::LogEntry>&
     #endif
 }
 
-const char* NukiLockComponent::get_auth_name(uint32_t authId) const {
-    for (size_t i = 0; i < auth_entries_count_; i++) {
-        if (auth_entries_[i].authId == authId) {
-            return auth_entries_[i].name;
-        }
-    }
-    return nullptr;
+void ResultProgress::begin(size_t expected, uint32_t now) {
+    this->started = now;
+    this->last_change = now;
+    this->count = 0;
+    this->expected = expected;
+    this->timed_out = false;
 }
 
-bool NukiLockComponent::execute_lock_action(NukiLock::LockAction lock_action) {
-    if (!this->nuki_lock_.isPairedWithLock()) {
-        ESP_LOGE(TAG, "Lock is not paired, cannot execute lock action");
-        return false;
+bool ResultProgress::update(size_t count, uint32_t now) {
+    if (count != this->count) {
+        this->count = count;
+        this->last_change = now;
     }
 
-    // Publish the assumed transitional lock state
-    switch (lock_action) {
-        case NukiLock::LockAction::Unlatch:
-        case NukiLock::LockAction::Unlock: {
-            this->publish_state(lock::LOCK_STATE_UNLOCKING);
-            break;
-        }
-        case NukiLock::LockAction::FullLock:
-        case NukiLock::LockAction::Lock:
-        case NukiLock::LockAction::LockNgo: {
-            this->publish_state(lock::LOCK_STATE_LOCKING);
-            break;
-        }
+    // The library delivers entries one by one, done once all arrived or they stopped coming in.
+    // The request already succeeded, an empty list (e.g. a caught up log cursor) is a valid result.
+    const bool all_received = count >= this->expected;
+    const bool settled = now - this->last_change >= RESULT_SETTLE_MILLIS;
+    this->elapsed = now - this->started;
+    this->timed_out = !all_received && !settled && this->elapsed >= RESULT_TIMEOUT_MILLIS;
+    return all_received || settled || this->timed_out;
+}
+
+bool NukiLockComponent::is_list_command(CommandType command) {
+    return command == CommandType::AuthData || command == CommandType::EventLog || command == CommandType::KeypadData;
+}
+
+// The library has no count of received entries, the result list of the command is reused for every check
+size_t NukiLockComponent::copy_entries(CommandType command, CommandData *data) {
+    switch (command) {
+        case CommandType::AuthData:
+            this->nuki_lock_.getAuthorizationEntries(&data->auth_entries);
+            return data->auth_entries.size();
+        case CommandType::EventLog:
+            this->nuki_lock_.getLogEntries(&data->log_entries);
+            return data->log_entries.size();
+        case CommandType::KeypadData:
+            this->nuki_lock_.getKeypadEntries(&data->keypad_entries);
+            return data->keypad_entries.size();
+        default:
+            return 0;
     }
+}
 
-    // Execute the action
-    Nuki::CmdResult result = this->nuki_lock_.lockAction(lock_action);
+/**
+ * @brief Waits on the worker until the entries of a list command arrived.
+ *
+ * The library appends them from its notification callback, so its lists are only
+ * read here and never from the main loop. The last check holds the complete result.
+ */
+void NukiLockComponent::collect_entries(CommandType command, CommandData *data) {
+    data->progress.begin(data->count, millis());
+    while (!data->progress.update(this->copy_entries(command, data), millis())) {
+        delay(RESULT_POLL_INTERVAL_MILLIS);
+    }
+}
 
-    App.feed_wdt();
+/**
+ * @brief Polls the entries of a list command from the main loop, used without the worker.
+ *
+ * No other command starts until they arrived, see process_commands().
+ */
+void NukiLockComponent::poll_entries(CommandType command, std::shared_ptr<CommandData> data) {
+    this->polling_entries_ = true;
+    data->progress.begin(data->count, millis());
 
-    char lock_action_as_string[30] = {0};
-    NukiLock::lockactionToString(lock_action, lock_action_as_string);
+    this->set_interval("poll_entries", RESULT_POLL_INTERVAL_MILLIS, [this, command, data]() {
+        if (!data->progress.update(this->copy_entries(command, data.get()), millis())) {
+            return;
+        }
 
-    char result_as_string[30] = {0};
-    NukiLock::cmdResultToString(result, result_as_string);
+        this->cancel_interval("poll_entries");
+        this->polling_entries_ = false;
 
-    if (result == Nuki::CmdResult::Success) {
-        ESP_LOGI(TAG, "lockAction %s (%d) has resulted in %s (%d)", lock_action_as_string, lock_action, result_as_string, result);
-        return true;
-    } else {
-        ESP_LOGE(TAG, "lockAction %s (%d) has resulted in %s (%d)", lock_action_as_string, lock_action, result_as_string, result);
-        return false;
-    }
+        this->complete_command(command, Nuki::CmdResult::Success, *data);
+    });
+}
+
+void NukiLockComponent::record_result_wait(CommandType command, const ResultProgress &progress) {
+    ResultWait *wait = nullptr;
+    switch (command) {
+        case CommandType::AuthData:
+            wait = &this->auth_data_wait_;
+            break;
+        case CommandType::EventLog:
+            wait = &this->event_log_wait_;
+            break;
+        case CommandType::KeypadData:
+            wait = &this->keypad_data_wait_;
+            break;
+        default:
+            return;
+    }
+
+    if (progress.timed_out) {
+        wait->timeouts++;
+    } else {
+        wait->completed++;
+    }
+    wait->last_millis = progress.elapsed;
+    wait->max_millis = std::max(wait->max_millis, progress.elapsed);
+
+    ESP_LOGD(TAG, "%s: %u of %u entries after %ums", CommandScheduler::command_type_to_string(command),
+        progress.count, progress.expected, progress.elapsed);
+}
+
+const char* NukiLockComponent::get_auth_name(uint32_t authId) const {
+    return this->auth_index_.find(authId);
+}
+
+void NukiLockComponent::request_auth_data_refresh(const char *reason) {
+    if (!this->auth_data_refresh_) {
+        ESP_LOGD(TAG, "Authorizations changed (%s), refreshing auth data", reason);
+    }
+    this->auth_data_refresh_ = true;
+    this->scheduler_.request(CommandType::AuthData);
+    this->trigger_commands();
+}
+
+void NukiLockComponent::check_auth_data_changed(const NukiLock::LogEntry& log) {
+    if (this->auth_data_refresh_ || log.authId == 0 || this->auth_index_.is_full()) {
+        return;
+    }
+
+    if (log.loggingType != NukiLock::LoggingType::LockAction &&
+        log.loggingType != NukiLock::LoggingType::KeypadAction) {
+        return;
+    }
+
+    const char* known_name = this->auth_index_.find(log.authId);
+    if (known_name == nullptr) {
+        this->request_auth_data_refresh("unknown auth id");
+        return;
+    }
+
+    // Keypad entries carry the name of the code, not the one of the authorization
+    if (log.loggingType == NukiLock::LoggingType::LockAction) {
+        char name[MAX_NAME_LEN + 1];
+        strncpy(name, reinterpret_cast<const char*>(log.name), MAX_NAME_LEN);
+        name[MAX_NAME_LEN] = '\0';
+
+        if (name[0] != '\0' && strcmp(known_name, name) != 0) {
+            this->request_auth_data_refresh("renamed authorization");
+        }
+    }
+}
+
+void NukiLockComponent::update_cooldown(CommandType command, bool success, uint32_t latency_millis) {
+    const LockModel model = this->get_lock_model();
+
+    if (success) {
+        this->cooldown_estimator_.record(model, command, latency_millis);
+    }
+
+    // Give the lock time to finish the command (and to turn the key after a successful action)
+    this->command_cooldown_millis = this->cooldown_estimator_.get_cooldown(model, command, success);
+    this->cooldown_command_ = command;
+
+    // Burst polling while the bolt is moving
+    if (command == CommandType::Status && success && this->transition_polls_ > 0 && this->transition_polls_ <= this->transition_poll_max_) {
+        this->command_cooldown_millis = this->get_transition_poll_gap();
+        ESP_LOGV(TAG, "Transition poll %u in %ums", this->transition_polls_, this->command_cooldown_millis);
+    }
+
+    if (success && (command == CommandType::Status || command == CommandType::LockAction)) {
+        this->publish_cooldown_sensors();
+    }
+}
+
+uint32_t NukiLockComponent::get_transition_poll_gap() const {
+    float gap = this->transition_poll_interval_;
+    for (uint8_t i = 1; i < this->transition_polls_; i++) {
+        gap *= this->transition_poll_backoff_;
+    }
+    return static_cast<uint32_t>(gap);
+}
+
+void NukiLockComponent::publish_cooldown_sensors() {
+    #ifdef USE_SENSOR
+    const LockModel model = this->get_lock_model();
+
+    if (this->status_cooldown_sensor_ != nullptr) {
+        const uint32_t cooldown = this->cooldown_estimator_.get_cooldown(model, CommandType::Status, true);
+        if (this->status_cooldown_sensor_->state != cooldown) {
+            this->status_cooldown_sensor_->publish_state(cooldown);
+        }
+    }
+    if (this->lock_action_cooldown_sensor_ != nullptr) {
+        const uint32_t cooldown = this->cooldown_estimator_.get_cooldown(model, CommandType::LockAction, true);
+        if (this->lock_action_cooldown_sensor_->state != cooldown) {
+            this->lock_action_cooldown_sensor_->publish_state(cooldown);
+        }
+    }
+    #endif
+}
+
+void NukiLockComponent::record_action_delay() {
+    if (!this->action_delay_pending_) {
+        return;
+    }
+    this->action_delay_pending_ = false;
+
+    // Time between control() and the first attempt to execute the action
+    const uint32_t delay = millis() - this->action_requested_time_;
+    ESP_LOGD(TAG, "Lock action started %ums after it was requested", delay);
+
+    #ifdef USE_SENSOR
+    if (this->lock_action_delay_sensor_ != nullptr) {
+        this->lock_action_delay_sensor_->publish_state(delay);
+    }
+    #endif
+}
+
+void NukiLockComponent::record_action_latency(lock::LockState state) {
+    if (!this->action_latency_pending_ || state != this->action_target_state_) {
+        return;
+    }
+    this->action_latency_pending_ = false;
+
+    // Time between control() and the first status confirming the requested state
+    const uint32_t latency = millis() - this->action_requested_time_;
+    ESP_LOGD(TAG, "Lock action confirmed %ums after it was requested", latency);
+
+    #ifdef USE_SENSOR
+    if (this->lock_action_latency_sensor_ != nullptr) {
+        this->lock_action_latency_sensor_->publish_state(latency);
+    }
+    #endif
+}
+
+void NukiLockComponent::publish_transitional_state(NukiLock::LockAction lock_action) {
+    // Publish the assumed transitional lock state
+    switch (lock_action) {
+        case NukiLock::LockAction::Unlatch:
+        case NukiLock::LockAction::Unlock: {
+            this->publish_state(lock::LOCK_STATE_UNLOCKING);
+            break;
+        }
+        case NukiLock::LockAction::FullLock:
+        case NukiLock::LockAction::Lock:
+        case NukiLock::LockAction::LockNgo:
+        case NukiLock::LockAction::LockNgoUnlatch: {
+            this->publish_state(lock::LOCK_STATE_LOCKING);
+            break;
+        }
+    }
+}
+
+bool NukiLockComponent::handle_lock_action_result(Nuki::CmdResult result) {
+    const NukiLock::LockAction lock_action = this->executing_lock_action_;
+
+    char lock_action_as_string[30] = {0};
+    NukiLock::lockactionToString(lock_action, lock_action_as_string);
+
+    char result_as_string[30] = {0};
+    NukiLock::cmdResultToString(result, result_as_string);
+
+    const bool success = result == Nuki::CmdResult::Success;
+
+    if (success) {
+        ESP_LOGI(TAG, "lockAction %s (%d) has resulted in %s (%d)", lock_action_as_string, lock_action, result_as_string, result);
+
+        if (this->lock_action_ == lock_action) {
+            // Stop action attempts only if no new action was received in the meantime.
+            // Otherwise, the new action won't be executed.
+            this->action_attempts_ = 0;
+        }
+
+        if (this->action_attempts_ == 0) {
+            this->piggyback_pending_commands();
+        }
+    } else {
+        ESP_LOGE(TAG, "lockAction %s (%d) has resulted in %s (%d)", lock_action_as_string, lock_action, result_as_string, result);
+
+        if (this->action_attempts_ == 0) {
+            this->connected_ = false;
+            this->action_latency_pending_ = false;
+
+            // Publish failed state only when no attempts are left
+            this->publish_state(lock::LOCK_STATE_NONE);
+
+            #ifdef USE_BINARY_SENSOR
+            if (this->connected_binary_sensor_ != nullptr)
+            {
+                this->connected_binary_sensor_->publish_state(this->connected_);
+            }
+            #endif
+        }
+    }
+
+    if (this->action_attempts_ > 0) {
+        this->scheduler_.request(CommandType::LockAction);
+    }
+
+    // Schedule a status update without waiting for the next advertisement for a faster feedback
+    this->scheduler_.request(CommandType::Status);
+
+    return success;
+}
+
+/**
+ * @brief Prepares a scheduled command and runs its BLE transaction.
+ *
+ * In async mode the transaction is handed to the BLE worker and the result is
+ * processed in loop(), otherwise it blocks until the lock answered.
+ */
+void NukiLockComponent::run_command(CommandType command) {
+    // Parameters are copied for the worker, the main loop may change them while the command runs
+    auto data = std::make_shared<CommandData>();
+
+    switch (command) {
+        case CommandType::LockAction: {
+            if (this->action_attempts_ == 0) {
+                this->skip_command(command);
+                return;
+            }
+
+            this->action_attempts_--;
+            this->executing_lock_action_ = this->lock_action_;
+            data->lock_action = this->executing_lock_action_;
+
+            char lock_action_as_string[30] = {0};
+            NukiLock::lockactionToString(this->executing_lock_action_, lock_action_as_string);
+            ESP_LOGD(TAG, "Executing lock action %s (%d)... (%d attempts left)", lock_action_as_string, this->executing_lock_action_, this->action_attempts_);
+
+            this->record_action_delay();
+            this->publish_transitional_state(this->executing_lock_action_);
+            break;
+        }
+        case CommandType::Status:
+            ESP_LOGD(TAG, "Requesting status...");
+            this->beacon_detector_.acknowledge();
+            break;
+        case CommandType::Config:
+            ESP_LOGD(TAG, "Requesting config...");
+            break;
+        case CommandType::AdvancedConfig:
+            ESP_LOGD(TAG, "Requesting advanced config...");
+            break;
+        case CommandType::AuthData:
+            if(this->pin_state_ != PinState::Valid) {
+                ESP_LOGW(TAG, "It seems like you did not set a valid pin!");
+                this->skip_command(command);
+                return;
+            }
+
+            // A known index is only probed, all pages are fetched once something changed.
+            // A full index cannot be probed, entries beyond its capacity always look new.
+            this->auth_data_probe_ = this->auth_data_offset_ == 0 && !this->auth_data_refresh_ &&
+                                     !this->auth_index_.empty() && !this->auth_index_.is_full();
+            if (this->auth_data_probe_) {
+                this->auth_data_probes_++;
+                data->offset = this->auth_index_.size() - 1;
+                data->count = AUTH_DATA_PROBE_SIZE;
+                ESP_LOGD(TAG, "Probing auth data...");
+            } else {
+                if (this->auth_data_offset_ == 0) {
+                    this->auth_data_refresh_ = false;
+                    this->auth_data_refreshes_++;
+                }
+                data->offset = this->auth_data_offset_;
+                data->count = AUTH_DATA_PAGE_SIZE;
+                ESP_LOGD(TAG, "Requesting auth data from offset %u...", this->auth_data_offset_);
+            }
+            break;
+        case CommandType::EventLog:
+            if(this->pin_state_ != PinState::Valid) {
+                ESP_LOGW(TAG, "It seems like you did not set a valid pin!");
+                this->skip_command(command);
+                return;
+            }
+
+            if (this->last_rolling_log_id == 0) {
+                // No cursor yet, only fetch the newest entries instead of the whole history
+                this->event_log_start_index_ = 0;
+                this->event_log_count_ = MAX_EVENT_LOG_ENTRIES;
+                ESP_LOGD(TAG, "Requesting event logs...");
+            } else {
+                this->event_log_start_index_ = this->last_rolling_log_id + 1;
+                this->event_log_count_ = EVENT_LOG_PAGE_SIZE;
+                ESP_LOGD(TAG, "Requesting event logs from index %u...", this->event_log_start_index_);
+            }
+            data->start_index = this->event_log_start_index_;
+            data->count = this->event_log_count_;
+            break;
+        case CommandType::KeypadData:
+            if(this->pin_state_ != PinState::Valid) {
+                ESP_LOGW(TAG, "It seems like you did not set a valid pin!");
+                this->skip_command(command);
+                return;
+            }
+            data->offset = this->keypad_data_offset_;
+            data->count = KEYPAD_DATA_PAGE_SIZE;
+            ESP_LOGD(TAG, "Requesting keypad codes from offset %u...", this->keypad_data_offset_);
+            break;
+        case CommandType::KeypadWrite:
+            if (this->keypad_operations_.empty()) {
+                this->skip_command(command);
+                return;
+            }
+            // Copied, the queue may grow while the worker executes the operation
+            this->executing_keypad_operation_ = this->keypad_operations_.front();
+            data->keypad_operation = this->executing_keypad_operation_;
+            ESP_LOGD(TAG, "Keypad batch #%u: %s...", this->executing_keypad_operation_.index,
+                keypad_operation_to_string(this->executing_keypad_operation_.type));
+            break;
+        default:
+            this->skip_command(command);
+            return;
+    }
+
+    if (this->ble_worker_.is_running()) {
+        const uint32_t generation = this->ble_generation_;
+
+        BleJob *job = new BleJob();
+        job->execute = [this, command, data]() {
+            data->started = millis();
+            Nuki::CmdResult result = this->execute_command(command, data.get());
+            data->duration_millis = millis() - data->started;
+
+            if (result == Nuki::CmdResult::Success && is_list_command(command)) {
+                this->collect_entries(command, data.get());
+            }
+            return result;
+        };
+        job->complete = [this, command, data, generation](Nuki::CmdResult result, uint32_t duration_millis) {
+            if (generation != this->ble_generation_) {
+                ESP_LOGD(TAG, "Dropping %s result from before unpairing", CommandScheduler::command_type_to_string(command));
+                return;
+            }
+            this->complete_command(command, result, *data);
+        };
+
+        if (!this->ble_worker_.submit(job)) {
+            this->scheduler_.request(command);
+        }
+        return;
+    }
+
+    data->started = millis();
+    Nuki::CmdResult result = this->execute_command(command, data.get());
+    data->duration_millis = millis() - data->started;
+
+    App.feed_wdt();
+
+    if (result == Nuki::CmdResult::Success && is_list_command(command)) {
+        this->poll_entries(command, data);
+        return;
+    }
+
+    this->complete_command(command, result, *data);
+}
+
+/**
+ * @brief The BLE transaction of a command, runs on the worker in async mode.
+ *
+ * Must not publish states or touch anything besides the lock library and data.
+ */
+Nuki::CmdResult NukiLockComponent::execute_command(CommandType command, CommandData *data) {
+    switch (command) {
+        case CommandType::LockAction:
+            return this->nuki_lock_.lockAction(data->lock_action);
+        case CommandType::Status:
+            return this->nuki_lock_.requestKeyTurnerState(&data->key_turner_state);
+        case CommandType::Config:
+            return this->nuki_lock_.requestConfig(&data->config);
+        case CommandType::AdvancedConfig:
+            return this->nuki_lock_.requestAdvancedConfig(&data->advanced_config);
+        case CommandType::AuthData:
+            return this->nuki_lock_.retrieveAuthorizationEntries(data->offset, data->count);
+        case CommandType::EventLog:
+            // Newest first without a cursor, otherwise oldest first starting at the cursor
+            return this->nuki_lock_.retrieveLogEntries(data->start_index, data->count, data->start_index == 0 ? 1 : 0, false);
+        case CommandType::KeypadData:
+            return this->nuki_lock_.retrieveKeypadEntries(data->offset, data->count);
+        case CommandType::KeypadWrite:
+            return this->execute_keypad_operation(data->keypad_operation);
+        default:
+            return Nuki::CmdResult::Error;
+    }
+}
+
+void NukiLockComponent::complete_command(CommandType command, Nuki::CmdResult result, CommandData &data) {
+    bool command_successful = false;
+
+    // Results of the worker are only applied here, on the main loop
+    if (result == Nuki::CmdResult::Success) {
+        this->record_result_wait(command, data.progress);
+
+        switch (command) {
+            case CommandType::Status:
+                this->retrieved_key_turner_state_ = data.key_turner_state;
+                break;
+            case CommandType::Config:
+                this->config_ = data.config;
+                break;
+            case CommandType::AdvancedConfig:
+                this->advanced_config_ = data.advanced_config;
+                break;
+            default:
+                break;
+        }
+    }
+
+    switch (command) {
+        case CommandType::LockAction:
+            command_successful = this->handle_lock_action_result(result);
+            break;
+        case CommandType::Status:
+            command_successful = this->handle_status_result(result);
+            break;
+        case CommandType::Config:
+            command_successful = this->handle_config_result(result);
+            break;
+        case CommandType::AdvancedConfig:
+            command_successful = this->handle_advanced_config_result(result);
+            break;
+        case CommandType::AuthData:
+            command_successful = this->handle_auth_data_result(result, data.auth_entries);
+            break;
+        case CommandType::EventLog:
+            command_successful = this->handle_event_log_result(result, data.log_entries);
+            break;
+        case CommandType::KeypadData:
+            command_successful = this->handle_keypad_data_result(result, data.keypad_entries);
+            break;
+        case CommandType::KeypadWrite:
+            command_successful = this->handle_keypad_write_result(result);
+            break;
+        default:
+            break;
+    }
+
+    // Latency of the transaction itself, without waiting for the entries of list commands
+    this->update_cooldown(command, command_successful, data.duration_millis);
+    this->count_ble_command(result == Nuki::CmdResult::Success);
+    this->command_trace_.record(to_trace_call(command), data.started, data.duration_millis, static_cast<int8_t>(result));
+
+    this->last_command_executed_time_ = millis();
+
+    if (this->scheduler_.has_pending()) {
+        this->trigger_commands();
+    }
+
+    if (this->session_open_ && command_successful) {
+        this->session_completed_++;
+        this->session_progress_time_ = millis();
+    }
+
+    // Failed keypad operations are reported, not retried, the batch is done once the queue is empty
+    const bool done = command_successful || (command == CommandType::KeypadWrite && this->keypad_operations_.empty());
+    this->finish_session_command(command, done);
+}
+
+/**
+ * @brief Finishes a scheduled command that has nothing to do, without a BLE transaction.
+ */
+void NukiLockComponent::skip_command(CommandType command) {
+    ESP_LOGV(TAG, "Skipping %s", CommandScheduler::command_type_to_string(command));
+    this->finish_session_command(command, true);
+}
+
+void NukiLockComponent::finish_session_command(CommandType command, bool done) {
+    if (!this->session_open_) {
+        return;
+    }
+
+    // Paged and batched commands request themselves again until done
+    if (done && !this->scheduler_.is_pending(command)) {
+        this->session_commands_ &= ~(1 << static_cast<uint8_t>(command));
+    }
+
+    if (this->session_commands_ == 0) {
+        this->end_session();
+    }
+}
+
+/**
+ * @brief Runs a batch of commands over a single BLE connection.
+ *
+ * The commands are scheduled as usual, but the connection is held open between
+ * them and closed as soon as the last one completed.
+ */
+void NukiLockComponent::start_session(std::initializer_list<CommandType> commands) {
+    for (CommandType command : commands) {
+        this->session_commands_ |= 1 << static_cast<uint8_t>(command);
+        this->scheduler_.request(command);
+    }
+}
+
+void NukiLockComponent::open_session() {
+    ESP_LOGD(TAG, "Opening session");
+
+    // Queued before the first command of the session
+    this->call_ble([this]() {
+        this->nuki_lock_.setDisconnectTimeout(BLE_SESSION_DISCONNECT_TIMEOUT);
+    });
+
+    this->session_open_ = true;
+    this->session_started_time_ = millis();
+    this->session_progress_time_ = this->session_started_time_;
+    this->session_completed_ = 0;
+    this->sessions_++;
+}
+
+/**
+ * @brief Sends queued background refreshes over the connection of a successful lock action.
+ *
+ * The link is already up and authenticated, so instead of letting it time out and
+ * reconnecting later, the pending refreshes and the follow-up status run as a session.
+ */
+void NukiLockComponent::piggyback_pending_commands() {
+    uint8_t piggybacked = 0;
+
+    for (CommandType command : {CommandType::Config, CommandType::AdvancedConfig, CommandType::AuthData, CommandType::EventLog}) {
+        if (this->scheduler_.is_pending(command)) {
+            this->start_session({command});
+            piggybacked++;
+        }
+    }
+
+    if (piggybacked == 0) {
+        return;
+    }
+
+    ESP_LOGD(TAG, "Piggybacking %u pending commands on the lock action connection", piggybacked);
+    this->piggybacked_commands_ += piggybacked;
+
+    this->start_session({CommandType::Status});
+    if (!this->session_open_) {
+        // The session includes the connection opened by the lock action
+        this->open_session();
+    }
+}
+
+void NukiLockComponent::end_session() {
+    // Every command after the first one reused the connection
+    if (this->session_completed_ > 1) {
+        this->connects_saved_ += this->session_completed_ - 1;
+    }
+
+    ESP_LOGD(TAG, "Closing session after %u commands in %ums", this->session_completed_, millis() - this->session_started_time_);
+
+    this->session_commands_ = 0;
+    this->session_open_ = false;
+
+    this->call_ble([this]() {
+        this->nuki_lock_.setDisconnectTimeout(BLE_DISCONNECT_TIMEOUT);
+        this->nuki_lock_.disconnect();
+    });
+
+    #ifdef USE_SENSOR
+    if (this->connects_saved_sensor_ != nullptr) {
+        this->connects_saved_sensor_->publish_state(this->connects_saved_);
+    }
+    #endif
+}
+
+/**
+ * @brief Runs a one-off BLE transaction and waits for its result.
+ *
+ * Goes through the worker in async mode so the lock library is never used by two tasks at once.
+ * Blocks the main loop, only for pairing and the PIN check, which need the result right away.
+ * Everything else uses submit_ble().
+ */
+Nuki::CmdResult NukiLockComponent::execute_ble(TraceCall call, std::function<Nuki::CmdResult()> &&execute) {
+    const uint32_t started = millis();
+    Nuki::CmdResult result = this->ble_worker_.execute(std::move(execute));
+    App.feed_wdt();
+
+    this->command_trace_.record(call, started, millis() - started, static_cast<int8_t>(result));
+    this->count_ble_command(result == Nuki::CmdResult::Success);
+    return result;
+}
+
+/**
+ * @brief Queues a one-off BLE transaction without waiting for its result.
+ *
+ * complete is called on the main loop once the worker finished. Runs inline without the worker.
+ */
+void NukiLockComponent::submit_ble(TraceCall call, std::function<Nuki::CmdResult()> &&execute,
+                                   std::function<void(Nuki::CmdResult result)> &&complete) {
+    const uint32_t generation = this->ble_generation_;
+    auto finish = [this, call, complete, generation](Nuki::CmdResult result, uint32_t duration_millis) {
+        this->command_trace_.record(call, millis() - duration_millis, duration_millis, static_cast<int8_t>(result));
+        this->count_ble_command(result == Nuki::CmdResult::Success);
+        if (generation != this->ble_generation_) {
+            ESP_LOGD(TAG, "Dropping %s result from before unpairing", CommandTrace::call_to_string(call));
+            return;
+        }
+        if (complete) {
+            complete(result);
+        }
+    };
+
+    if (!this->ble_worker_.is_running()) {
+        const uint32_t started = millis();
+        Nuki::CmdResult result = execute();
+        App.feed_wdt();
+        finish(result, millis() - started);
+        return;
+    }
+
+    BleJob *job = new BleJob();
+    job->execute = std::move(execute);
+    job->complete = std::move(finish);
+    if (!this->ble_worker_.submit(job) && complete) {
+        complete(Nuki::CmdResult::Error);
+    }
+}
+
+/**
+ * @brief Queues a library call that is not a transaction of its own, e.g. a disconnect.
+ *
+ * Keeps every use of the lock library on the worker, in order with the queued transactions.
+ */
+void NukiLockComponent::call_ble(std::function<void()> &&call) {
+    if (!this->ble_worker_.is_running()) {
+        call();
+        return;
+    }
+
+    // Keeps the order behind calls that are still waiting for a slot
+    if (!this->pending_ble_calls_.empty() || !this->submit_call_ble(call)) {
+        ESP_LOGW(TAG, "Worker queue full, retrying library call later");
+        this->pending_ble_calls_.push_back(std::move(call));
+    }
+}
+
+bool NukiLockComponent::submit_call_ble(const std::function<void()> &call) {
+    BleJob *job = new BleJob();
+    job->execute = [call]() {
+        call();
+        return Nuki::CmdResult::Success;
+    };
+    return this->ble_worker_.submit(job, true);
+}
+
+void NukiLockComponent::flush_ble_calls() {
+    while (!this->pending_ble_calls_.empty() && this->submit_call_ble(this->pending_ble_calls_.front())) {
+        this->pending_ble_calls_.pop_front();
+    }
+}
+
+void NukiLockComponent::count_ble_command(bool success) {
+    this->last_ble_activity_time_ = millis();
+    this->ble_commands_++;
+    if (!success) {
+        this->ble_command_errors_++;
+    }
+
+    #ifdef USE_SENSOR
+    if (this->ble_commands_sensor_ != nullptr) {
+        this->ble_commands_sensor_->publish_state(this->ble_commands_);
+    }
+    #endif
 }
 
 void NukiLockComponent::set_security_pin(uint32_t new_pin) {
@@ -1215,9 +2059,9 @@ void NukiLockComponent::validate_pin()
 
             ESP_LOGD(TAG, "verifySecurityPin attempts left: %d", remaining_attempts);
 
-            Nuki::CmdResult pin_result = this->nuki_lock_.verifySecurityPin();
-
-            App.feed_wdt();
+            Nuki::CmdResult pin_result = this->execute_ble(TraceCall::VerifyPin, [this]() {
+                return this->nuki_lock_.verifySecurityPin();
+            });
 
             if(pin_result == Nuki::CmdResult::Success) {
                 ESP_LOGI(TAG, "Nuki Lock PIN is valid");
@@ -1248,6 +2092,7 @@ void NukiLockComponent::validate_pin()
 void NukiLockComponent::setup() {
     ESP_LOGCONFIG(TAG, "Running setup");
 
+    #ifdef USE_ESP32
     // Increase Watchdog Timeout
     // Fixes Pairing Crash
     esp_task_wdt_config_t wdt_config = {
@@ -1255,6 +2100,7 @@ void NukiLockComponent::setup() {
         .trigger_panic = false
     }; 
     esp_task_wdt_reconfigure(&wdt_config);
+    #endif
 
     // Restore settings from flash
     this->pref_ = global_preferences->make_preference<NukiLockSettings>(global_nuki_lock_id);
@@ -1267,6 +2113,14 @@ void NukiLockComponent::setup() {
     this->pin_state_ = recovered.pin_state;
     this->security_pin_ = recovered.security_pin;
 
+    this->cache_pref_ = global_preferences->make_preference<NukiLockCache>(global_nuki_lock_cache_id);
+    this->load_cache();
+
+    // Declared keypad codes are reconciled once the keypad codes were fetched
+    this->keypad_sync_pending_ = !this->keypad_codes_.empty();
+
+    this->setup_scheduler();
+
     this->traits.set_supported_states({
         lock::LOCK_STATE_NONE,
         lock::LOCK_STATE_LOCKED,
@@ -1322,23 +2176,35 @@ void NukiLockComponent::setup() {
 
     this->nuki_lock_.initialize();
     this->nuki_lock_.registerBleScanner(&this->scanner_);
+    this->scanner_.subscribe(&this->beacon_detector_);
     this->nuki_lock_.setConnectTimeout(BLE_CONNECT_TIMEOUT_SEC);
     this->nuki_lock_.setConnectRetries(BLE_CONNECT_RETRIES);
     this->nuki_lock_.setDisconnectTimeout(BLE_DISCONNECT_TIMEOUT);
     this->nuki_lock_.setGeneralTimeout(this->ble_general_timeout_ * 1000);
     this->nuki_lock_.setCommandTimeout(this->ble_command_timeout_ * 1000);
+
+    if (this->async_commands_) {
+        if (this->ble_worker_.start()) {
+            ESP_LOGD(TAG, "BLE commands run on a separate worker task");
+        } else {
+            ESP_LOGE(TAG, "Failed to start the BLE worker, falling back to blocking commands");
+        }
+    }
     
     App.feed_wdt();
 
     if (this->nuki_lock_.isPairedWithLock()) {
-        this->status_update_ = true;
+        this->beacon_detector_.set_address(this->nuki_lock_.getBleAddress());
 
-        // First boot: Request config and auth data
-        this->config_update_ = true;
-        this->advanced_config_update_ = true;
+        // First boot: Request status, config and auth data over one connection
+        this->start_session({CommandType::Status, CommandType::Config, CommandType::AdvancedConfig});
         if (this->send_events_) {
-            this->auth_data_update_ = true;
-            this->event_log_update_ = true;
+            if (!this->auth_index_.empty()) {
+                // User names are restored from the cache, the auth data interval refreshes them
+                this->start_session({CommandType::EventLog});
+            } else {
+                this->start_session({CommandType::AuthData, CommandType::EventLog});
+            }
         }
 
         const char* pairing_type = this->pairing_as_app_.value_or(false) ? "App" : "Bridge";
@@ -1377,6 +2243,9 @@ void NukiLockComponent::setup() {
         this->register_service(&NukiLockComponent::add_keypad_entry, "add_keypad_entry", {"name", "code"});
         this->register_service(&NukiLockComponent::update_keypad_entry, "update_keypad_entry", {"id", "name", "code", "enabled"});
         this->register_service(&NukiLockComponent::delete_keypad_entry, "delete_keypad_entry", {"id"});
+        this->register_service(&NukiLockComponent::keypad_batch, "keypad_batch", {"operations", "ids", "names", "codes", "enabled"});
+        this->register_service(&NukiLockComponent::sync_keypad_codes, "sync_keypad_codes", {"names", "codes", "enabled"});
+        this->register_service(&NukiLockComponent::print_command_trace, "print_command_trace");
         #else
         ESP_LOGW(TAG, "CUSTOM API SERVICES ARE DISABLED");
         ESP_LOGW(TAG, "Please set 'api:' -> 'custom_services: true' to use API services.");
@@ -1402,27 +2271,98 @@ void NukiLockComponent::publish_pin_state() {
     #endif
 }
 
+void NukiLockComponent::setup_scheduler() {
+    this->scheduler_.configure(CommandType::LockAction, PRIORITY_CRITICAL, 0);
+    this->scheduler_.configure(CommandType::Status, 50, DEADLINE_STATUS_MILLIS);
+    this->scheduler_.configure(CommandType::Config, 40, DEADLINE_CONFIG_MILLIS);
+    this->scheduler_.configure(CommandType::AuthData, 30, DEADLINE_AUTH_DATA_MILLIS);
+    this->scheduler_.configure(CommandType::EventLog, 20, DEADLINE_EVENT_LOG_MILLIS);
+    this->scheduler_.configure(CommandType::KeypadData, 15, DEADLINE_KEYPAD_DATA_MILLIS);
+    this->scheduler_.configure(CommandType::KeypadWrite, 45, DEADLINE_KEYPAD_WRITE_MILLIS);
+    this->scheduler_.configure(CommandType::AdvancedConfig, 10, DEADLINE_ADVANCED_CONFIG_MILLIS);
+}
+
 void NukiLockComponent::setup_intervals(bool setup) {
     this->cancel_interval("update_config");
     this->cancel_interval("update_auth_data");
 
     if(setup) {
         this->set_interval("update_config", this->query_interval_config_ * 1000, [this]() {
-            this->config_update_ = true;
-            this->advanced_config_update_ = true;
+            this->start_session({CommandType::Config, CommandType::AdvancedConfig});
         });
     
+        // Safety net only, changes are detected from the event log. Probes unless a refresh is pending.
         this->set_interval("update_auth_data", this->query_interval_auth_data_ * 1000, [this]() {
-            this->auth_data_update_ = true;
+            this->scheduler_.request(CommandType::AuthData);
         });
     }
 }
 
+void NukiLockComponent::loop() {
+    // Results of BLE transactions that finished on the worker
+    this->ble_worker_.process_completions();
+    this->flush_ble_calls();
+
+    // Events notified by the lock library
+    this->process_events();
+}
+
 void NukiLockComponent::update() {
-    // Check for new advertisements
+    // Idle, the scan is running and there is no connection to terminate
+    if (this->is_ble_idle()) {
+        if (millis() - this->last_scanner_update_time_ >= BLE_IDLE_SCANNER_UPDATE_MILLIS) {
+            this->last_scanner_update_time_ = millis();
+            this->scanner_.update();
+        }
+        return;
+    }
+
+    // Check for new advertisements, connections stop the scan
+    this->last_scanner_update_time_ = millis();
     this->scanner_.update();
-    App.feed_wdt();
-    delay(20);
+
+    this->process_commands();
+}
+
+/**
+ * @brief True if no command or session is pending and the last connection timed out.
+ */
+bool NukiLockComponent::is_ble_idle() {
+    if (this->session_open_ || this->polling_entries_ || this->scheduler_.has_pending() || !this->ble_worker_.is_idle() ||
+        !this->pending_ble_calls_.empty()) {
+        return false;
+    }
+
+    // Sessions raise the disconnect timeout, the library closes the connection at the latest after that
+    if (millis() - this->last_ble_activity_time_ <= BLE_SESSION_DISCONNECT_TIMEOUT + BLE_DISCONNECT_TIMEOUT) {
+        return false;
+    }
+
+    return this->nuki_lock_.isPairedWithLock() && !this->pairing_mode_;
+}
+
+/**
+ * @brief Reacts to a new job right away instead of waiting for the next update() tick.
+ */
+void NukiLockComponent::trigger_commands() {
+    if (this->event_driven_) {
+        this->defer("process_commands", [this]() {
+            this->process_commands();
+        });
+    }
+}
+
+void NukiLockComponent::process_commands() {
+    // The previous command is still running on the BLE worker
+    if (!this->ble_worker_.is_idle()) {
+        return;
+    }
+
+    // Without the worker, the previous list command may still be receiving its entries.
+    // Starting another request now would mix both results.
+    if (this->polling_entries_) {
+        return;
+    }
 
     /*int64_t ts = millis();
     int64_t last_received_beacon_ts = this->nuki_lock_.getLastReceivedBeaconTs();
@@ -1432,17 +2372,41 @@ void NukiLockComponent::update() {
         ESP_LOGW(TAG, "We received no BLE beacon for %d seconds!", (ts - last_received_beacon_ts) / 1000);
     }*/
 
-    // Terminate stale Bluetooth connections
+    if (this->session_open_ && millis() - this->session_progress_time_ > BLE_SESSION_TIMEOUT_MILLIS) {
+        ESP_LOGW(TAG, "Session made no progress within %ums", BLE_SESSION_TIMEOUT_MILLIS);
+        this->end_session();
+    }
+
+    // Terminate stale Bluetooth connections, safe on the main loop while the worker is idle
     this->nuki_lock_.updateConnectionState();
 
-    App.feed_wdt();
+    // Idle, nothing else to do until a command is requested
+    if (!this->scheduler_.has_pending() && this->nuki_lock_.isPairedWithLock()) {
+        return;
+    }
 
     if (millis() - last_command_executed_time_ < command_cooldown_millis) {
         // Give the lock time to terminate the previous command
         uint64_t millisSinceLastExecution = millis() - last_command_executed_time_;
         uint64_t millisLeft = (millisSinceLastExecution < command_cooldown_millis) ? command_cooldown_millis - millisSinceLastExecution : 1;
-        ESP_LOGV(TAG, "Cooldown period, %dms left", millisLeft);
-        return;
+
+        // A pending lock action cuts short the cooldown of a background command,
+        // someone might be standing at the door. Actions still wait for each other.
+        if (this->scheduler_.is_pending(CommandType::LockAction) && this->cooldown_command_ != CommandType::LockAction) {
+            ESP_LOGD(TAG, "Lock action preempts %s cooldown, %dms left", CommandScheduler::command_type_to_string(this->cooldown_command_), millisLeft);
+            this->cooldown_preemptions_++;
+            this->command_cooldown_millis = 0;
+        } else {
+            ESP_LOGV(TAG, "Cooldown period, %dms left", millisLeft);
+
+            if (this->event_driven_ && this->scheduler_.has_pending()) {
+                // Continue right after the cooldown
+                this->set_timeout("process_commands", millisLeft, [this]() {
+                    this->process_commands();
+                });
+            }
+            return;
+        }
     }
 
     if (this->nuki_lock_.isPairedWithLock()) {
@@ -1453,70 +2417,19 @@ void NukiLockComponent::update() {
         } 
         #endif
 
-        // Execute (all) actions first, then status updates, then config updates.
+        // Lock actions always run first, background refreshes are picked by priority, age and deadline.
         // Only one command (action, status, config, or auth data) is executed per update() call.
-        if (this->action_attempts_ > 0) {
-            this->action_attempts_--;
-
-            NukiLock::LockAction currentLockAction = this->lock_action_;
-            char currentlock_action_as_string[30] = {0};
-            NukiLock::lockactionToString(currentLockAction, currentlock_action_as_string);
-
-            ESP_LOGD(TAG, "Executing lock action %s (%d)... (%d attempts left)", currentlock_action_as_string, currentLockAction, this->action_attempts_);
-
-            bool isExecutionSuccessful = this->execute_lock_action(currentLockAction);
-
-            App.feed_wdt();
-
-            if (isExecutionSuccessful) {
-                if (this->lock_action_ == currentLockAction) {
-                    // Stop action attempts only if no new action was received in the meantime.
-                    // Otherwise, the new action won't be executed.
-                    this->action_attempts_ = 0;
-                }
-            } else if (this->action_attempts_ == 0) {
-                this->connected_ = false;
-                
-                // Publish failed state only when no attempts are left
-                this->publish_state(lock::LOCK_STATE_NONE);
-
-                #ifdef USE_BINARY_SENSOR
-                if (this->connected_binary_sensor_ != nullptr)
-                {
-                    this->connected_binary_sensor_->publish_state(this->connected_);
-                }  
-                #endif
-            }
-
-            // Schedule a status update without waiting for the next advertisement for a faster feedback
-            this->status_update_ = true;
-
-            // Give the lock extra time when successful in order to account for time to turn the key
-            command_cooldown_millis = isExecutionSuccessful ? COOLDOWN_COMMANDS_EXTENDED_MILLIS : COOLDOWN_COMMANDS_MILLIS;
+        CommandType command;
+        if (!this->scheduler_.next(&command)) {
+            return;
+        }
+        this->scheduler_.start(command);
 
-        } else if (this->status_update_) {
-            ESP_LOGD(TAG, "Requesting status...");
-            this->update_status();
-            command_cooldown_millis = COOLDOWN_COMMANDS_MILLIS;
-        } else if (this->config_update_) {
-            ESP_LOGD(TAG, "Requesting config...");
-            this->update_config();
-            command_cooldown_millis = COOLDOWN_COMMANDS_MILLIS;
-        } else if (this->auth_data_update_) {
-            ESP_LOGD(TAG, "Requesting auth data...");
-            this->update_auth_data();
-            command_cooldown_millis = COOLDOWN_COMMANDS_MILLIS;
-        } else if (this->event_log_update_) {
-            ESP_LOGD(TAG, "Requesting event logs...");
-            this->update_event_logs();
-            command_cooldown_millis = COOLDOWN_COMMANDS_MILLIS;
-        } else if (this->advanced_config_update_) {
-            ESP_LOGD(TAG, "Requesting advanced config...");
-            this->update_advanced_config();
-            command_cooldown_millis = COOLDOWN_COMMANDS_MILLIS;
+        if (this->session_commands_ != 0 && !this->session_open_) {
+            this->open_session();
         }
 
-        last_command_executed_time_ = millis();
+        this->run_command(command);
 
     } else {
         this->connected_ = false;
@@ -1537,7 +2450,11 @@ void NukiLockComponent::update() {
             
             App.feed_wdt();
 
-            bool paired = this->nuki_lock_.pairNuki(type) == Nuki::PairingResult::Success;
+            bool paired = false;
+            this->execute_ble(TraceCall::Pair, [this, type, &paired]() {
+                paired = this->nuki_lock_.pairNuki(type) == Nuki::PairingResult::Success;
+                return paired ? Nuki::CmdResult::Success : Nuki::CmdResult::Failed;
+            });
 
             App.feed_wdt();
 
@@ -1546,10 +2463,22 @@ void NukiLockComponent::update() {
                 const char* lock_type = this->nuki_lock_.isLockUltra() ? "Ultra / Go / 5th Gen" : "1st - 4th Gen";
                 ESP_LOGI(TAG, "Successfully paired as %s with a %s smart lock!", pairing_type, lock_type);
 
-                this->update_status();
+                this->beacon_detector_.set_address(this->nuki_lock_.getBleAddress());
+
+                NukiLock::KeyTurnerState key_turner_state;
+                Nuki::CmdResult status_result = this->execute_ble(TraceCall::Status, [this, &key_turner_state]() {
+                    return this->nuki_lock_.requestKeyTurnerState(&key_turner_state);
+                });
+                if (status_result == Nuki::CmdResult::Success) {
+                    this->retrieved_key_turner_state_ = key_turner_state;
+                }
+                this->handle_status_result(status_result);
                 this->paired_callback_.call();
                 this->set_pairing_mode(false);
 
+                // Fetch the settings of the new lock while still connected
+                this->start_session({CommandType::Config, CommandType::AdvancedConfig});
+
                 // Save initial security pin after pairing
                 // Pairing resets the security pin
                 const uint32_t pin_to_use = this->security_pin_ != 0 ? this->security_pin_ : this->security_pin_config_.value_or(0);
@@ -1638,6 +2567,14 @@ void NukiLockComponent::control(const lock::LockCall &call) {
             return;
     }
 
+    this->scheduler_.request(CommandType::LockAction);
+    this->trigger_commands();
+
+    this->action_requested_time_ = millis();
+    this->action_delay_pending_ = true;
+    this->action_latency_pending_ = true;
+    this->action_target_state_ = state;
+
     char lock_action_as_string[30] = {0};
     NukiLock::lockactionToString(this->lock_action_, lock_action_as_string);
     lock_action_as_string[sizeof(lock_action_as_string) - 1] = '\0';
@@ -1650,7 +2587,13 @@ void NukiLockComponent::lock_n_go() {
 }
 
 bool NukiLockComponent::valid_keypad_id(int32_t id) {
-    bool is_valid = std::find(keypad_code_ids_.begin(), keypad_code_ids_.end(), id) != keypad_code_ids_.end();
+    if (!this->keypad_cache_.is_valid()) {
+        ESP_LOGE(TAG, "Keypad codes are not loaded yet, try again later.");
+        this->request_keypad_data(true);
+        return false;
+    }
+
+    bool is_valid = id >= 0 && id <= UINT16_MAX && this->keypad_cache_.find(id) != nullptr;
     if (!is_valid) {
         ESP_LOGE(TAG, "Keypad id %d unknown.", id);
     }
@@ -1661,6 +2604,9 @@ bool NukiLockComponent::valid_keypad_name(std::string name) {
     bool name_valid = !(name == "" || name == "--");
     if (!name_valid) {
         ESP_LOGE(TAG, "Keypad name '%s' is invalid.", name.c_str());
+    } else if (name.length() > KEYPAD_NAME_LEN) {
+        ESP_LOGE(TAG, "Keypad name '%s' is longer than %u characters.", name.c_str(), KEYPAD_NAME_LEN);
+        name_valid = false;
     }
     return name_valid;
 }
@@ -1699,12 +2645,17 @@ void NukiLockComponent::add_keypad_entry(std::string name, int32_t code) {
     size_t name_len = name.length();
     memcpy(&entry.name, name.c_str(), name_len > 20 ? 20 : name_len);
     entry.code = code;
-    Nuki::CmdResult result = this->nuki_lock_.addKeypadEntry(entry);
-    if (result == Nuki::CmdResult::Success) {
-        ESP_LOGI(TAG, "add_keypad_entry is sucessful");
-    } else {
-        ESP_LOGE(TAG, "add_keypad_entry: addKeypadEntry failed (result %d)", result);
-    }
+    this->submit_ble(TraceCall::Keypad, [this, entry]() mutable {
+        return this->nuki_lock_.addKeypadEntry(entry);
+    }, [this](Nuki::CmdResult result) {
+        if (result == Nuki::CmdResult::Success) {
+            ESP_LOGI(TAG, "add_keypad_entry is sucessful");
+            // The lock assigns the id, fetch the new code
+            this->request_keypad_data(false);
+        } else {
+            ESP_LOGE(TAG, "add_keypad_entry: addKeypadEntry failed (result %d)", result);
+        }
+    });
 }
 
 void NukiLockComponent::update_keypad_entry(int32_t id, std::string name, int32_t code, bool enabled) {
@@ -1723,55 +2674,413 @@ void NukiLockComponent::update_keypad_entry(int32_t id, std::string name, int32_
         return;
     }
 
-    if (!(valid_keypad_id(id) && valid_keypad_name(name) && valid_keypad_code(code))) {
-        ESP_LOGE(TAG, "update_keypad_entry invalid parameters");
-        return;
+    if (!(valid_keypad_id(id) && valid_keypad_name(name) && valid_keypad_code(code))) {
+        ESP_LOGE(TAG, "update_keypad_entry invalid parameters");
+        return;
+    }
+
+    NukiLock::UpdatedKeypadEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.codeId = id;
+    size_t name_len = name.length();
+    memcpy(&entry.name, name.c_str(), name_len > 20 ? 20 : name_len);
+    entry.code = code;
+    entry.enabled = enabled ? 1 : 0;
+    this->submit_ble(TraceCall::Keypad, [this, entry]() mutable {
+        return this->nuki_lock_.updateKeypadEntry(entry);
+    }, [this, id, name, code, enabled](Nuki::CmdResult result) {
+        if (result == Nuki::CmdResult::Success) {
+            ESP_LOGI(TAG, "update_keypad_entry is sucessful");
+            this->keypad_cache_.update(id, name.c_str(), code, enabled);
+            this->schedule_cache_save();
+        } else {
+            ESP_LOGE(TAG, "update_keypad_entry: updateKeypadEntry failed (result %d)", result);
+        }
+    });
+}
+
+void NukiLockComponent::delete_keypad_entry(int32_t id) {
+    if (!this->nuki_lock_.isPairedWithLock()) {
+        ESP_LOGE(TAG, "Lock is not paired, cannot retrieve delete entry");
+        return;
+    }
+
+    if (!keypad_paired_) {
+        ESP_LOGE(TAG, "keypad is not paired to Nuki");
+        return;
+    }
+
+    if(this->pin_state_ != PinState::Valid) {
+        ESP_LOGW(TAG, "It seems like you did not set a valid pin!");
+        return;
+    }
+
+    if (!valid_keypad_id(id)) {
+        ESP_LOGE(TAG, "delete_keypad_entry invalid parameters");
+        return;
+    }
+
+    this->submit_ble(TraceCall::Keypad, [this, id]() {
+        return this->nuki_lock_.deleteKeypadEntry(id);
+    }, [this, id](Nuki::CmdResult result) {
+        if (result == Nuki::CmdResult::Success) {
+            ESP_LOGI(TAG, "delete_keypad_entry is sucessful");
+            this->keypad_cache_.remove(id);
+            this->schedule_cache_save();
+        } else {
+            ESP_LOGE(TAG, "delete_keypad_entry: deleteKeypadEntry failed (result %d)", result);
+        }
+    });
+}
+
+void NukiLockComponent::keypad_batch(std::vector<std::string> operations, std::vector<int32_t> ids, std::vector<std::string> names,
+                                     std::vector<int32_t> codes, std::vector<bool> enabled) {
+    if (!this->nuki_lock_.isPairedWithLock()) {
+        ESP_LOGE(TAG, "Lock is not paired, cannot run keypad batch");
+        return;
+    }
+
+    if (!keypad_paired_) {
+        ESP_LOGE(TAG, "Keypad is not paired to Nuki");
+        return;
+    }
+
+    if(this->pin_state_ != PinState::Valid) {
+        ESP_LOGW(TAG, "It seems like you did not set a valid pin!");
+        return;
+    }
+
+    const size_t count = operations.size();
+    if (ids.size() != count || names.size() != count || codes.size() != count || enabled.size() != count) {
+        ESP_LOGE(TAG, "keypad_batch: operations, ids, names, codes and enabled must have the same length");
+        return;
+    }
+
+    // Validate everything before anything is sent to the lock
+    std::vector<KeypadOperation> batch;
+    batch.reserve(count);
+    bool valid = true;
+
+    for (size_t i = 0; i < count; i++) {
+        KeypadOperation operation;
+        memset(&operation, 0, sizeof(operation));
+        operation.index = i;
+        operation.enabled = enabled[i];
+
+        if (operations[i] == "add") {
+            operation.type = KeypadOperationType::Add;
+            operation.enabled = true;
+            valid &= valid_keypad_name(names[i]) && valid_keypad_code(codes[i]);
+        } else if (operations[i] == "update") {
+            operation.type = KeypadOperationType::Update;
+            valid &= valid_keypad_id(ids[i]) && valid_keypad_name(names[i]) && valid_keypad_code(codes[i]);
+        } else if (operations[i] == "delete") {
+            operation.type = KeypadOperationType::Delete;
+            valid &= valid_keypad_id(ids[i]);
+        } else {
+            ESP_LOGE(TAG, "keypad_batch #%u: unknown operation '%s'", i, operations[i].c_str());
+            valid = false;
+        }
+
+        if (operation.type != KeypadOperationType::Delete) {
+            for (size_t j = 0; j < i; j++) {
+                if (operations[j] != "delete" && names[j] == names[i]) {
+                    ESP_LOGE(TAG, "keypad_batch #%u: keypad name '%s' is used more than once", i, names[i].c_str());
+                    valid = false;
+                    break;
+                }
+            }
+        }
+
+        operation.id = ids[i];
+        operation.code = codes[i];
+        memcpy(operation.name, names[i].c_str(), strnlen(names[i].c_str(), KEYPAD_NAME_LEN));
+        batch.push_back(operation);
+    }
+
+    if (!valid) {
+        ESP_LOGE(TAG, "keypad_batch invalid parameters, nothing was changed");
+        return;
+    }
+
+    this->queue_keypad_operations(std::move(batch));
+}
+
+bool NukiLockComponent::queue_keypad_operations(std::vector<KeypadOperation> &&operations) {
+    if (operations.empty()) {
+        return true;
+    }
+
+    if (this->keypad_operations_.size() + operations.size() > KEYPAD_BATCH_MAX_OPERATIONS) {
+        ESP_LOGE(TAG, "Too many keypad operations queued (max. %u)", KEYPAD_BATCH_MAX_OPERATIONS);
+        return false;
+    }
+
+    ESP_LOGI(TAG, "Queueing %u keypad operations", operations.size());
+    for (const auto& operation : operations) {
+        this->keypad_operations_.push_back(operation);
+    }
+
+    this->start_session({CommandType::KeypadWrite});
+    this->trigger_commands();
+    return true;
+}
+
+void NukiLockComponent::sync_keypad_codes(std::vector<std::string> names, std::vector<int32_t> codes, std::vector<bool> enabled) {
+    if (!this->nuki_lock_.isPairedWithLock()) {
+        ESP_LOGE(TAG, "Lock is not paired, cannot sync keypad codes");
+        return;
+    }
+
+    if (!keypad_paired_) {
+        ESP_LOGE(TAG, "Keypad is not paired to Nuki");
+        return;
+    }
+
+    if(this->pin_state_ != PinState::Valid) {
+        ESP_LOGW(TAG, "It seems like you did not set a valid pin!");
+        return;
+    }
+
+    const size_t count = names.size();
+    if (count == 0 || codes.size() != count || enabled.size() != count) {
+        ESP_LOGE(TAG, "sync_keypad_codes: names, codes and enabled must have the same length and must not be empty");
+        return;
+    }
+
+    if (count > KEYPAD_CACHE_CAPACITY) {
+        ESP_LOGE(TAG, "sync_keypad_codes: at most %u codes are supported", KEYPAD_CACHE_CAPACITY);
+        return;
+    }
+
+    std::vector<KeypadCode> keypad_codes;
+    keypad_codes.reserve(count);
+    bool valid = true;
+
+    for (size_t i = 0; i < count; i++) {
+        valid &= valid_keypad_name(names[i]) && valid_keypad_code(codes[i]);
+
+        for (const auto& keypad_code : keypad_codes) {
+            if (keypad_code.name == names[i]) {
+                ESP_LOGE(TAG, "Keypad name '%s' is used more than once.", names[i].c_str());
+                valid = false;
+            }
+        }
+
+        keypad_codes.push_back({names[i], static_cast<uint32_t>(codes[i]), enabled[i]});
+    }
+
+    if (!valid) {
+        ESP_LOGE(TAG, "sync_keypad_codes invalid parameters, nothing was changed");
+        return;
+    }
+
+    this->keypad_codes_ = std::move(keypad_codes);
+    this->keypad_sync_pending_ = true;
+    this->keypad_sync_followup_ = false;
+    this->request_keypad_data(true);
+}
+
+/**
+ * @brief Queues the keypad operations needed to reach the declared codes.
+ *
+ * Codes are matched by name. Missing codes are added, codes with a different
+ * code or enabled state are updated and duplicates of a declared name are
+ * deleted. Codes not declared at all are only deleted in exclusive mode.
+ */
+void NukiLockComponent::reconcile_keypad_codes() {
+    if (!this->keypad_operations_.empty()) {
+        // Retried once the running batch finished
+        return;
+    }
+    this->keypad_sync_pending_ = false;
+
+    std::vector<KeypadOperation> operations;
+    std::vector<bool> matched(this->keypad_cache_.size(), false);
+    uint16_t unchanged = 0;
+
+    auto queue = [&operations](KeypadOperationType type, uint16_t id, const char *name, uint32_t code, bool enabled) {
+        KeypadOperation operation;
+        memset(&operation, 0, sizeof(operation));
+        operation.type = type;
+        operation.index = operations.size();
+        operation.id = id;
+        operation.code = code;
+        operation.enabled = enabled;
+        memcpy(operation.name, name, strnlen(name, KEYPAD_NAME_LEN));
+        operations.push_back(operation);
+    };
+
+    for (const auto& keypad_code : this->keypad_codes_) {
+        // Prefer an entry that already has the right code
+        int current = -1;
+        for (size_t i = 0; i < this->keypad_cache_.size(); i++) {
+            const KeypadCacheEntry& entry = this->keypad_cache_.get(i);
+            if (matched[i] || keypad_code.name != entry.name) {
+                continue;
+            }
+            if (current < 0 || entry.code == keypad_code.code) {
+                current = i;
+            }
+        }
+
+        if (current < 0) {
+            queue(KeypadOperationType::Add, 0, keypad_code.name.c_str(), keypad_code.code, true);
+            continue;
+        }
+
+        matched[current] = true;
+        const KeypadCacheEntry& entry = this->keypad_cache_.get(current);
+        if (entry.code != keypad_code.code || (entry.enabled != 0) != keypad_code.enabled) {
+            queue(KeypadOperationType::Update, entry.code_id, keypad_code.name.c_str(), keypad_code.code, keypad_code.enabled);
+        } else {
+            unchanged++;
+        }
+    }
+
+    for (size_t i = 0; i < this->keypad_cache_.size(); i++) {
+        if (matched[i]) {
+            continue;
+        }
+
+        const KeypadCacheEntry& entry = this->keypad_cache_.get(i);
+        bool declared = false;
+        for (const auto& keypad_code : this->keypad_codes_) {
+            declared |= keypad_code.name == entry.name;
+        }
+
+        if (declared || this->keypad_codes_exclusive_) {
+            queue(KeypadOperationType::Delete, entry.code_id, entry.name, entry.code, false);
+        }
     }
 
-    NukiLock::UpdatedKeypadEntry entry;
-    memset(&entry, 0, sizeof(entry));
-    entry.codeId = id;
-    size_t name_len = name.length();
-    memcpy(&entry.name, name.c_str(), name_len > 20 ? 20 : name_len);
-    entry.code = code;
-    entry.enabled = enabled ? 1 : 0;
-    Nuki::CmdResult result = this->nuki_lock_.updateKeypadEntry(entry);
-    if (result == Nuki::CmdResult::Success) {
-        ESP_LOGI(TAG, "update_keypad_entry is sucessful");
-    } else {
-        ESP_LOGE(TAG, "update_keypad_entry: updateKeypadEntry failed (result %d)", result);
+    // New codes are always enabled by the lock, disabled ones are updated after they were fetched.
+    // Only one follow-up pass, a rejected add must not cause endless refreshes.
+    bool disabled_added = false;
+    for (const auto& keypad_code : this->keypad_codes_) {
+        if (!keypad_code.enabled && this->keypad_cache_.find_by_name(keypad_code.name.c_str()) == nullptr) {
+            disabled_added = true;
+        }
     }
+    this->keypad_sync_pending_ = disabled_added && !this->keypad_sync_followup_;
+    this->keypad_sync_followup_ = this->keypad_sync_pending_;
+
+    ESP_LOGI(TAG, "Keypad sync: %u codes unchanged, %u operations needed", unchanged, operations.size());
+    this->queue_keypad_operations(std::move(operations));
 }
 
-void NukiLockComponent::delete_keypad_entry(int32_t id) {
-    if (!this->nuki_lock_.isPairedWithLock()) {
-        ESP_LOGE(TAG, "Lock is not paired, cannot retrieve delete entry");
-        return;
+Nuki::CmdResult NukiLockComponent::execute_keypad_operation(const KeypadOperation &operation) {
+    switch (operation.type) {
+        case KeypadOperationType::Add:
+        {
+            NukiLock::NewKeypadEntry entry;
+            memset(&entry, 0, sizeof(entry));
+            memcpy(&entry.name, operation.name, strnlen(operation.name, KEYPAD_NAME_LEN));
+            entry.code = operation.code;
+            return this->nuki_lock_.addKeypadEntry(entry);
+        }
+        case KeypadOperationType::Update:
+        {
+            NukiLock::UpdatedKeypadEntry entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.codeId = operation.id;
+            memcpy(&entry.name, operation.name, strnlen(operation.name, KEYPAD_NAME_LEN));
+            entry.code = operation.code;
+            entry.enabled = operation.enabled ? 1 : 0;
+            return this->nuki_lock_.updateKeypadEntry(entry);
+        }
+        case KeypadOperationType::Delete:
+            return this->nuki_lock_.deleteKeypadEntry(operation.id);
+        default:
+            return Nuki::CmdResult::Error;
     }
+}
 
-    if (!keypad_paired_) {
-        ESP_LOGE(TAG, "keypad is not paired to Nuki");
-        return;
+bool NukiLockComponent::handle_keypad_write_result(Nuki::CmdResult keypad_write_result) {
+    const KeypadOperation &operation = this->executing_keypad_operation_;
+    if (!this->keypad_operations_.empty()) {
+        this->keypad_operations_.pop_front();
     }
 
-    if(this->pin_state_ != PinState::Valid) {
-        ESP_LOGW(TAG, "It seems like you did not set a valid pin!");
-        return;
+    char result_as_string[30] = {0};
+    NukiLock::cmdResultToString(keypad_write_result, result_as_string);
+
+    if (keypad_write_result == Nuki::CmdResult::Success) {
+        ESP_LOGI(TAG, "Keypad batch #%u %s '%s' (id %u) is successful", operation.index,
+            keypad_operation_to_string(operation.type), operation.name, operation.id);
+        this->keypad_batch_succeeded_++;
+
+        switch (operation.type) {
+            case KeypadOperationType::Add:
+                this->keypad_batch_added_ = true;
+                break;
+            case KeypadOperationType::Update:
+                this->keypad_cache_.update(operation.id, operation.name, operation.code, operation.enabled);
+                break;
+            case KeypadOperationType::Delete:
+                this->keypad_cache_.remove(operation.id);
+                break;
+        }
+    } else {
+        ESP_LOGE(TAG, "Keypad batch #%u %s '%s' (id %u) failed: %s (%d)", operation.index,
+            keypad_operation_to_string(operation.type), operation.name, operation.id, result_as_string, keypad_write_result);
+        this->keypad_batch_failed_++;
     }
 
-    if (!valid_keypad_id(id)) {
-        ESP_LOGE(TAG, "delete_keypad_entry invalid parameters");
-        return;
+    #ifdef USE_API_HOMEASSISTANT_SERVICES
+    if (this->send_events_) {
+        EventPayload event_data;
+        event_data.add("type", "KeypadBatch");
+        event_data.add("index", operation.index);
+        event_data.add("operation", keypad_operation_to_string(operation.type));
+        event_data.add("codeId", operation.id);
+        event_data.add("name", operation.name);
+        event_data.add("result", result_as_string);
+        this->fire_homeassistant_event(this->event_, event_data.to_map());
     }
+    #endif
 
-    Nuki::CmdResult result = this->nuki_lock_.deleteKeypadEntry(id);
-    if (result == Nuki::CmdResult::Success) {
-        ESP_LOGI(TAG, "delete_keypad_entry is sucessful");
+    if (!this->keypad_operations_.empty()) {
+        this->scheduler_.request(CommandType::KeypadWrite);
     } else {
-        ESP_LOGE(TAG, "delete_keypad_entry: deleteKeypadEntry failed (result %d)", result);
+        ESP_LOGI(TAG, "Keypad batch finished: %u successful, %u failed", this->keypad_batch_succeeded_, this->keypad_batch_failed_);
+        this->keypad_batch_succeeded_ = 0;
+        this->keypad_batch_failed_ = 0;
+
+        // The lock assigns the ids of new codes, fetch them once for the whole batch
+        if (this->keypad_batch_added_) {
+            this->keypad_batch_added_ = false;
+            this->request_keypad_data(false);
+        }
+
+        // A sync requested while the batch was running needs the current codes
+        if (this->keypad_sync_pending_) {
+            this->request_keypad_data(true);
+        }
+        this->schedule_cache_save();
+    }
+
+    // Failed operations are reported, not retried. Only transport errors count as failed commands.
+    return keypad_write_result != Nuki::CmdResult::TimeOut && keypad_write_result != Nuki::CmdResult::Error;
+}
+
+const char *NukiLockComponent::keypad_operation_to_string(KeypadOperationType type) {
+    switch (type) {
+        case KeypadOperationType::Add:
+            return "add";
+        case KeypadOperationType::Update:
+            return "update";
+        case KeypadOperationType::Delete:
+            return "delete";
+        default:
+            return "unknown";
     }
 }
 
+void NukiLockComponent::print_command_trace() {
+    this->command_trace_.dump();
+}
+
 void NukiLockComponent::print_keypad_entries() {
     if (!this->nuki_lock_.isPairedWithLock()) {
         ESP_LOGE(TAG, "Lock is not paired, cannot retrieve keypad entries");
@@ -1788,23 +3097,29 @@ void NukiLockComponent::print_keypad_entries() {
         return;
     }
 
-    Nuki::CmdResult result = this->nuki_lock_.retrieveKeypadEntries(0, 0xffff);
-    if (result == Nuki::CmdResult::Success) {
-        ESP_LOGI(TAG, "retrieveKeypadEntries sucess");
-        std::list<NukiLock::KeypadEntry> entries;
-        this->nuki_lock_.getKeypadEntries(&entries);
+    // Printed once the refresh finished
+    this->keypad_print_pending_ = true;
+    this->request_keypad_data(true);
+}
 
-        entries.sort([](const NukiLock::KeypadEntry& a, const NukiLock::KeypadEntry& b) { return a.codeId < b.codeId; });
+void NukiLockComponent::print_keypad_cache() {
+    for (size_t i = 0; i < this->keypad_cache_.size(); i++) {
+        const KeypadCacheEntry& entry = this->keypad_cache_.get(i);
+        ESP_LOGI(TAG, "keypad #%d %s is %s", entry.code_id, entry.name, entry.enabled ? "enabled" : "disabled");
+    }
+}
 
-        keypad_code_ids_.clear();
-        keypad_code_ids_.reserve(entries.size());
-        for (const auto& entry : entries) {
-            keypad_code_ids_.push_back(entry.codeId);
-            ESP_LOGI(TAG, "keypad #%d %s is %s", entry.codeId, entry.name, entry.enabled ? "enabled" : "disabled");
-        }
-    } else {
-        ESP_LOGE(TAG, "print_keypad_entries: retrieveKeypadEntries failed (result %d)", result);
+void NukiLockComponent::request_keypad_data(bool full) {
+    // A running full refresh already covers new codes
+    if (full && !this->keypad_data_full_) {
+        this->keypad_data_full_ = true;
+        this->keypad_data_offset_ = 0;
+    } else if (!this->keypad_data_full_) {
+        this->keypad_data_offset_ = this->keypad_cache_.size();
     }
+
+    this->scheduler_.request(CommandType::KeypadData);
+    this->trigger_commands();
 }
 
 void NukiLockComponent::dump_config() {
@@ -1822,17 +3137,40 @@ void NukiLockComponent::dump_config() {
 
     ESP_LOGCONFIG(TAG, "  Pairing Identity: %s", this->pairing_as_app_.value_or(false) ? "App" : "Bridge");
     ESP_LOGCONFIG(TAG, "  Is Paired: %s", YESNO(this->is_paired()));
+    ESP_LOGCONFIG(TAG, "  Event log cursor: %u, cached auth entries: %u", this->last_rolling_log_id, this->auth_index_.size());
+    ESP_LOGCONFIG(TAG, "  Auth data probes: %u, refreshes: %u", this->auth_data_probes_, this->auth_data_refreshes_);
+    ESP_LOGCONFIG(TAG, "  Cached keypad codes: %u%s", this->keypad_cache_.size(), this->keypad_cache_.is_valid() ? "" : " (incomplete)");
+    ESP_LOGCONFIG(TAG, "  Declared keypad codes: %u%s", this->keypad_codes_.size(), this->keypad_codes_exclusive_ ? " (exclusive)" : "");
+    ESP_LOGCONFIG(TAG, "  Auth data results: %u (%u timed out), last %ums, max. %ums",
+        this->auth_data_wait_.completed, this->auth_data_wait_.timeouts, this->auth_data_wait_.last_millis, this->auth_data_wait_.max_millis);
+    ESP_LOGCONFIG(TAG, "  Event log results: %u (%u timed out), last %ums, max. %ums",
+        this->event_log_wait_.completed, this->event_log_wait_.timeouts, this->event_log_wait_.last_millis, this->event_log_wait_.max_millis);
 
     ESP_LOGCONFIG(TAG, "  Pairing mode timeout: %us", this->pairing_mode_timeout_);
     ESP_LOGCONFIG(TAG, "  Configuration query interval: %us", this->query_interval_config_);
-    ESP_LOGCONFIG(TAG, "  Auth Data query interval: %us", this->query_interval_auth_data_);
+    ESP_LOGCONFIG(TAG, "  Auth Data check interval: %us", this->query_interval_auth_data_);
     ESP_LOGCONFIG(TAG, "  BLE general timeout: %us", this->ble_general_timeout_);
     ESP_LOGCONFIG(TAG, "  BLE command timeout: %us", this->ble_command_timeout_);
+    ESP_LOGCONFIG(TAG, "  Event driven: %s", YESNO(this->event_driven_));
+    ESP_LOGCONFIG(TAG, "  Async BLE commands: %s", this->ble_worker_.is_running() ? "Enabled" : (this->async_commands_ ? "Failed to start" : "Disabled"));
 
     char pin_state_as_string[30] = {0};
     this->pin_state_to_string(this->pin_state_, pin_state_as_string);
     ESP_LOGCONFIG(TAG, "  Last known security pin state: %s", pin_state_as_string);
 
+    this->scheduler_.dump_config();
+    ESP_LOGCONFIG(TAG, "  BLE commands: %u (%u failed)", this->ble_commands_, this->ble_command_errors_);
+    ESP_LOGCONFIG(TAG, "  Sessions: %u, connects saved: %u, piggybacked on lock actions: %u", this->sessions_, this->connects_saved_, this->piggybacked_commands_);
+    ESP_LOGCONFIG(TAG, "  Cooldown preemptions by lock actions: %u", this->cooldown_preemptions_);
+    ESP_LOGCONFIG(TAG, "  Beacons: %u, state changes: %u, status queries avoided: %u, RSSI: %d",
+        this->beacon_detector_.get_beacons(),
+        this->beacon_detector_.get_changes(),
+        this->status_queries_avoided_,
+        this->beacon_detector_.get_rssi()
+    );
+    ESP_LOGCONFIG(TAG, "  Transition polling: %ums, backoff %.2f, max. %u polls", this->transition_poll_interval_, this->transition_poll_backoff_, this->transition_poll_max_);
+    this->cooldown_estimator_.dump_config(this->get_lock_model());
+
     LOG_LOCK(TAG, "Nuki Lock", this);
     #ifdef USE_BINARY_SENSOR
     LOG_BINARY_SENSOR(TAG, "Connected", this->connected_binary_sensor_);
@@ -1850,6 +3188,13 @@ void NukiLockComponent::dump_config() {
     #ifdef USE_SENSOR
     LOG_SENSOR(TAG, "Battery Level", this->battery_level_sensor_);
     LOG_SENSOR(TAG, "Bluetooth Signal", this->bt_signal_sensor_);
+    LOG_SENSOR(TAG, "Status Cooldown", this->status_cooldown_sensor_);
+    LOG_SENSOR(TAG, "Lock Action Cooldown", this->lock_action_cooldown_sensor_);
+    LOG_SENSOR(TAG, "Lock Action Delay", this->lock_action_delay_sensor_);
+    LOG_SENSOR(TAG, "Connects Saved", this->connects_saved_sensor_);
+    LOG_SENSOR(TAG, "Lock Action Latency", this->lock_action_latency_sensor_);
+    LOG_SENSOR(TAG, "Status Queries Avoided", this->status_queries_avoided_sensor_);
+    LOG_SENSOR(TAG, "BLE Commands", this->ble_commands_sensor_);
     #endif
     #ifdef USE_BUTTON
     LOG_BUTTON(TAG, "Unpair", this->unpair_button_);
@@ -1857,50 +3202,45 @@ void NukiLockComponent::dump_config() {
     #endif
     #ifdef USE_SWITCH
     LOG_SWITCH(TAG, "Pairing Mode", this->pairing_mode_switch_);
-    LOG_SWITCH(TAG, "Pairing Enabled", this->pairing_enabled_switch_);
-    LOG_SWITCH(TAG, "Auto Unlatch Enabled", this->auto_unlatch_enabled_switch_);
-    LOG_SWITCH(TAG, "Button Enabled", this->button_enabled_switch_);
-    LOG_SWITCH(TAG, "LED Enabled", this->led_enabled_switch_);
-    LOG_SWITCH(TAG, "Night Mode Enabled", this->nightmode_enabled_switch_);
-    LOG_SWITCH(TAG, "Night Mode Auto Lock", this->night_mode_auto_lock_enabled_switch_);
-    LOG_SWITCH(TAG, "Night Mode Auto Unlock Disabled", this->night_mode_auto_unlock_disabled_switch_);
-    LOG_SWITCH(TAG, "Night Mode Immediate Lock On Start", this->night_mode_immediate_lock_on_start_switch_);
-    LOG_SWITCH(TAG, "Auto Lock", this->auto_lock_enabled_switch_);
-    LOG_SWITCH(TAG, "Auto Unlock Disabled", this->auto_unlock_disabled_switch_);
-    LOG_SWITCH(TAG, "Immediate Auto Lock", this->immediate_auto_lock_enabled_switch_);
-    LOG_SWITCH(TAG, "Automatic Updates", this->auto_update_enabled_switch_);
-    LOG_SWITCH(TAG, "Single Lock Enabled", this->single_lock_enabled_switch_);
-    LOG_SWITCH(TAG, "DST Mode Enabled", this->dst_mode_enabled_switch_);
-    LOG_SWITCH(TAG, "Slow Speed During Night Mode Enabled", this->slow_speed_during_night_mode_enabled_switch_);
-    LOG_SWITCH(TAG, "Detached Cylinder Enabled", this->detached_cylinder_enabled_switch_);
+    for (const auto& descriptor : CONFIG_SWITCHES) {
+        LOG_SWITCH(TAG, descriptor.label, this->*descriptor.entity);
+    }
     #endif
     #ifdef USE_NUMBER
-    LOG_NUMBER(TAG, "LED Brightness", this->led_brightness_number_);
-    LOG_NUMBER(TAG, "Timezone Offset", this->timezone_offset_number_);
-    LOG_NUMBER(TAG, "LockNGo Timeout", this->lock_n_go_timeout_number_);
-    LOG_NUMBER(TAG, "Auto Lock Timeout", this->auto_lock_timeout_number_);
-    LOG_NUMBER(TAG, "Unlatch Duration", this->unlatch_duration_number_);
-    LOG_NUMBER(TAG, "Unlocked Position Offset Degrees", this->unlocked_position_offset_number_);
-    LOG_NUMBER(TAG, "Locked Position Offset Degrees", this->locked_position_offset_number_);
-    LOG_NUMBER(TAG, "Single Locked Position Offset Degrees", this->single_locked_position_offset_number_);
-    LOG_NUMBER(TAG, "Unlocked To Locked Transition Offset Degrees", this->unlocked_to_locked_transition_offset_number_);
+    for (const auto& descriptor : CONFIG_NUMBERS) {
+        LOG_NUMBER(TAG, descriptor.label, this->*descriptor.entity);
+    }
     #endif
     #ifdef USE_SELECT
-    LOG_SELECT(TAG, "Single Button Press Action", this->single_button_press_action_select_);
-    LOG_SELECT(TAG, "Double Button Press Action", this->double_button_press_action_select_);
-    LOG_SELECT(TAG, "Fob Action 1", this->fob_action_1_select_);
-    LOG_SELECT(TAG, "Fob Action 2", this->fob_action_2_select_);
-    LOG_SELECT(TAG, "Fob Action 3", this->fob_action_3_select_);
-    LOG_SELECT(TAG, "Timezone", this->timezone_select_);
-    LOG_SELECT(TAG, "Advertising Mode", this->advertising_mode_select_);
-    LOG_SELECT(TAG, "Battery Type", this->battery_type_select_);
-    LOG_SELECT(TAG, "Motor Speed", this->motor_speed_select_);
+    for (const auto& descriptor : CONFIG_SELECTS) {
+        LOG_SELECT(TAG, descriptor.label, this->*descriptor.entity);
+    }
     #endif
 }
 
 void NukiLockComponent::notify(Nuki::EventType event_type) {
+    // Called from within the lock library, which may run on the BLE worker
+    this->pending_events_.fetch_or(1u << static_cast<uint8_t>(event_type));
+}
+
+void NukiLockComponent::process_events() {
+    const uint32_t events = this->pending_events_.exchange(0);
+    if (events == 0) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < 32; i++) {
+        if (events & (1u << i)) {
+            this->handle_event(static_cast<Nuki::EventType>(i));
+        }
+    }
+}
+
+void NukiLockComponent::handle_event(Nuki::EventType event_type) {
     ESP_LOGI(TAG, "Event notified %d", event_type);
 
+    this->command_trace_.record(TraceCall::Event, millis(), 0, static_cast<int8_t>(event_type));
+
     if(event_type == Nuki::EventType::KeyTurnerStatusReset) {
         // IDK
         ESP_LOGD(TAG, "KeyTurnerStatusReset");
@@ -1926,8 +3266,24 @@ void NukiLockComponent::notify(Nuki::EventType event_type) {
     } else if(event_type == Nuki::EventType::KeyTurnerStatusUpdated) {
         ESP_LOGD(TAG, "KeyTurnerStatusUpdated");
 
-        // Request status update (incl. event log request)
-        this->status_update_ = true;
+        if (this->beacon_detector_.is_valid() && !this->beacon_detector_.has_change()) {
+            // Repeated beacon of a change that was already queried
+            this->status_queries_avoided_++;
+            ESP_LOGV(TAG, "No new state change advertised, skipping status request");
+
+            #ifdef USE_SENSOR
+            if (this->status_queries_avoided_sensor_ != nullptr) {
+                this->status_queries_avoided_sensor_->publish_state(this->status_queries_avoided_);
+            }
+            if (this->bt_signal_sensor_ != nullptr && this->bt_signal_sensor_->state != this->beacon_detector_.get_rssi()) {
+                this->bt_signal_sensor_->publish_state(this->beacon_detector_.get_rssi());
+            }
+            #endif
+        } else {
+            // Request status update (incl. event log request)
+            this->scheduler_.request(CommandType::Status);
+            this->trigger_commands();
+        }
     } else if(event_type == Nuki::EventType::BLE_ERROR_ON_DISCONNECT) {
         ESP_LOGE(TAG, "Failed to disconnect from Nuki. Restarting ESP...");
         delay(100);  // NOLINT
@@ -1941,7 +3297,14 @@ void NukiLockComponent::unpair() {
         return;
     }
 
-    this->nuki_lock_.unPairNuki();
+    // Results of commands still queued on the worker belong to the old pairing
+    this->ble_generation_++;
+
+    // Runs after the commands still queued on the worker
+    this->submit_ble(TraceCall::Unpair, [this]() {
+        this->nuki_lock_.unPairNuki();
+        return Nuki::CmdResult::Success;
+    });
 
     this->connected_ = false;
 
@@ -1959,6 +3322,33 @@ void NukiLockComponent::unpair() {
     this->save_settings();
 
     this->setup_intervals(false);
+    this->cancel_interval("poll_entries");
+    this->polling_entries_ = false;
+    this->scheduler_.clear();
+    this->beacon_detector_.clear();
+    this->last_rolling_log_id = 0;
+    this->auth_index_.clear();
+    this->auth_data_offset_ = 0;
+    this->auth_data_refresh_ = false;
+    this->keypad_cache_.clear();
+    this->keypad_data_full_ = false;
+    this->keypad_data_offset_ = 0;
+    this->keypad_print_pending_ = false;
+    this->keypad_operations_.clear();
+    this->config_changes_.clear();
+    this->config_valid_ = false;
+    this->advanced_config_valid_ = false;
+    this->config_checked_ = false;
+    this->advanced_config_checked_ = false;
+    this->config_update_count_valid_ = false;
+    this->own_config_updates_ = 0;
+    this->keypad_sync_pending_ = !this->keypad_codes_.empty();
+    this->schedule_cache_save();
+    this->action_attempts_ = 0;
+    if (this->session_open_) {
+        this->end_session();
+    }
+    this->session_commands_ = 0;
 
     ESP_LOGI(TAG, "Unpaired Nuki! Turn on Pairing Mode to pair a new Nuki.");
 }
@@ -1969,12 +3359,15 @@ void NukiLockComponent::request_calibration() {
         return;
     }
 
-    Nuki::CmdResult result = this->nuki_lock_.requestCalibration();
-    if (result == Nuki::CmdResult::Success) {
-        ESP_LOGI(TAG, "Calibration requested successfully");
-    } else {
-        ESP_LOGE(TAG, "Failed to request calibration (result %d)", result);
-    }
+    this->submit_ble(TraceCall::Calibration, [this]() {
+        return this->nuki_lock_.requestCalibration();
+    }, [](Nuki::CmdResult result) {
+        if (result == Nuki::CmdResult::Success) {
+            ESP_LOGI(TAG, "Calibration requested successfully");
+        } else {
+            ESP_LOGE(TAG, "Failed to request calibration (result %d)", result);
+        }
+    });
 }
 
 void NukiLockComponent::set_pairing_mode(bool enabled) {
@@ -2018,265 +3411,353 @@ void NukiLockComponent::set_pairing_mode(bool enabled) {
     }
 }
 
-#ifdef USE_SELECT
-void NukiLockComponent::set_config_select(const char* config, const char* value) {
+bool NukiLockComponent::is_config_supported(ConfigModel model) {
+    switch (model) {
+        case ConfigModel::NonUltra:
+            return !this->nuki_lock_.isLockUltra();
+        case ConfigModel::Ultra:
+            return this->nuki_lock_.isLockUltra();
+        default:
+            return true;
+    }
+}
+
+const char *NukiLockComponent::config_change_name(const ConfigChange &change) {
+    switch (change.type) {
+        #ifdef USE_SWITCH
+        case ConfigEntityType::Switch:
+            return CONFIG_SWITCHES[change.index].name;
+        #endif
+        #ifdef USE_NUMBER
+        case ConfigEntityType::Number:
+            return CONFIG_NUMBERS[change.index].name;
+        #endif
+        #ifdef USE_SELECT
+        case ConfigEntityType::Select:
+            return CONFIG_SELECTS[change.index].name;
+        #endif
+        default:
+            return "unknown";
+    }
+}
+
+void NukiLockComponent::apply_config_change(const ConfigChange &change, NukiLock::Config *config, NukiLock::AdvancedConfig *advanced_config) {
+    switch (change.type) {
+        #ifdef USE_SWITCH
+        case ConfigEntityType::Switch: {
+            const ConfigSwitchDescriptor &descriptor = CONFIG_SWITCHES[change.index];
+            if (descriptor.advanced) {
+                descriptor.set_advanced_config(*advanced_config, change.value != 0);
+            } else {
+                descriptor.set_config(*config, change.value != 0);
+            }
+            break;
+        }
+        #endif
+        #ifdef USE_NUMBER
+        case ConfigEntityType::Number: {
+            const ConfigNumberDescriptor &descriptor = CONFIG_NUMBERS[change.index];
+            if (descriptor.advanced) {
+                descriptor.set_advanced_config(*advanced_config, change.value);
+            } else {
+                descriptor.set_config(*config, change.value);
+            }
+            break;
+        }
+        #endif
+        #ifdef USE_SELECT
+        case ConfigEntityType::Select: {
+            const ConfigSelectDescriptor &descriptor = CONFIG_SELECTS[change.index];
+            if (descriptor.advanced) {
+                descriptor.set_advanced_config(*advanced_config, change.value);
+            } else {
+                descriptor.set_config(*config, change.value);
+            }
+            break;
+        }
+        #endif
+        default:
+            break;
+    }
+}
+
+void NukiLockComponent::publish_config_change(const ConfigChange &change) {
+    switch (change.type) {
+        #ifdef USE_SWITCH
+        case ConfigEntityType::Switch: {
+            switch_::Switch *entity = this->*CONFIG_SWITCHES[change.index].entity;
+            if (entity != nullptr) {
+                entity->publish_state(change.value != 0);
+            }
+            break;
+        }
+        #endif
+        #ifdef USE_NUMBER
+        case ConfigEntityType::Number: {
+            number::Number *entity = this->*CONFIG_NUMBERS[change.index].entity;
+            if (entity != nullptr) {
+                entity->publish_state(change.value);
+            }
+            break;
+        }
+        #endif
+        #ifdef USE_SELECT
+        case ConfigEntityType::Select: {
+            const ConfigSelectDescriptor &descriptor = CONFIG_SELECTS[change.index];
+            select::Select *entity = this->*descriptor.entity;
+            if (entity != nullptr) {
+                char str[50] = {0};
+                descriptor.to_string(this, change.value, str);
+                entity->publish_state(str);
+            }
+            break;
+        }
+        #endif
+        default:
+            break;
+    }
+}
+
+void NukiLockComponent::publish_config_settings(bool advanced) {
+    const NukiLock::Config &config = this->config_;
+    const NukiLock::AdvancedConfig &advanced_config = this->advanced_config_;
+
+    #ifdef USE_SWITCH
+    for (const auto& descriptor : CONFIG_SWITCHES) {
+        switch_::Switch *entity = this->*descriptor.entity;
+        if (descriptor.advanced == advanced && entity != nullptr && this->is_config_supported(descriptor.model)) {
+            entity->publish_state(advanced ? descriptor.get_advanced_config(advanced_config) : descriptor.get_config(config));
+        }
+    }
+    #endif
+    #ifdef USE_NUMBER
+    for (const auto& descriptor : CONFIG_NUMBERS) {
+        number::Number *entity = this->*descriptor.entity;
+        if (descriptor.advanced == advanced && entity != nullptr && this->is_config_supported(descriptor.model)) {
+            entity->publish_state(advanced ? descriptor.get_advanced_config(advanced_config) : descriptor.get_config(config));
+        }
+    }
+    #endif
+    #ifdef USE_SELECT
+    for (const auto& descriptor : CONFIG_SELECTS) {
+        select::Select *entity = this->*descriptor.entity;
+        if (descriptor.advanced == advanced && entity != nullptr && this->is_config_supported(descriptor.model)) {
+            char str[50] = {0};
+            descriptor.to_string(this, advanced ? descriptor.get_advanced_config(advanced_config) : descriptor.get_config(config), str);
+            entity->publish_state(str);
+        }
+    }
+    #endif
+}
+
+void NukiLockComponent::queue_config_change(ConfigChange &&change) {
+    bool replaced = false;
+    for (auto& pending : this->config_changes_) {
+        if (pending.type == change.type && pending.index == change.index) {
+            pending = change;
+            replaced = true;
+            break;
+        }
+    }
+
+    if (!replaced) {
+        this->config_changes_.push_back(change);
+    }
+
+    ESP_LOGD(TAG, "%u setting changes pending", this->config_changes_.size());
+
+    // Restarted by every change, so settings changed together end up in one write
+    this->set_timeout("config_write", CONFIG_WRITE_DELAY_MILLIS, [this]() {
+        this->write_config_changes();
+    });
+}
+
+void NukiLockComponent::write_config_changes() {
+    if (this->config_changes_.empty()) {
+        return;
+    }
+
+    // Without the worker the write runs inline, wait until the running list command got its entries
+    if (this->polling_entries_) {
+        this->set_timeout("config_write", RESULT_POLL_INTERVAL_MILLIS, [this]() {
+            this->write_config_changes();
+        });
+        return;
+    }
+
+    std::vector<ConfigChange> changes = std::move(this->config_changes_);
+    this->config_changes_.clear();
+
     if (!this->nuki_lock_.isPairedWithLock()) {
-        ESP_LOGE(TAG, "Lock is not paired, cannot change setting %s", config);
-        return;
-    }
-
-    Nuki::CmdResult cmd_result = (Nuki::CmdResult)-1;
-    bool is_advanced = false;
-
-    // Update Config
-    if (strcmp(config, "single_button_press_action") == 0) {
-        NukiLock::ButtonPressAction action = this->button_press_action_to_enum(value);
-        cmd_result = this->nuki_lock_.setSingleButtonPressAction(action);
-        is_advanced = true;
-    } else if (strcmp(config, "double_button_press_action") == 0) {
-        NukiLock::ButtonPressAction action = this->button_press_action_to_enum(value);
-        cmd_result = this->nuki_lock_.setDoubleButtonPressAction(action);
-        is_advanced = true;
-    } else if (strcmp(config, "fob_action_1") == 0) {
-        const uint8_t action = this->fob_action_to_int(value);
-        if (action != 99) {
-            cmd_result = this->nuki_lock_.setFobAction(1, action);
-        }
-    } else if (strcmp(config, "fob_action_2") == 0) {
-        const uint8_t action = this->fob_action_to_int(value);
-        if (action != 99) {
-            cmd_result = this->nuki_lock_.setFobAction(2, action);
-        }
-    } else if (strcmp(config, "fob_action_3") == 0) {
-        const uint8_t action = this->fob_action_to_int(value);
-        if (action != 99) {
-            cmd_result = this->nuki_lock_.setFobAction(3, action);
-        }
-    } else if (strcmp(config, "timezone") == 0) {
-        Nuki::TimeZoneId tzid = this->timezone_to_enum(value);
-        cmd_result = this->nuki_lock_.setTimeZoneId(tzid);
-    } else if (strcmp(config, "advertising_mode") == 0) {
-        Nuki::AdvertisingMode mode = this->advertising_mode_to_enum(value);
-        cmd_result = this->nuki_lock_.setAdvertisingMode(mode);
-    } else if (!this->nuki_lock_.isLockUltra() && strcmp(config, "battery_type") == 0) {
-        Nuki::BatteryType type = this->battery_type_to_enum(value);
-        cmd_result = this->nuki_lock_.setBatteryType(type);
-        is_advanced = true;
-    } else if (this->nuki_lock_.isLockUltra() && strcmp(config, "motor_speed") == 0) {
-        NukiLock::MotorSpeed speed = this->motor_speed_to_enum(value);
-        cmd_result = this->nuki_lock_.setMotorSpeed(speed);
-        is_advanced = true;
+        ESP_LOGE(TAG, "Lock is not paired, cannot change %u settings", changes.size());
+        return;
     }
 
-    if (cmd_result == Nuki::CmdResult::Success) {
-        if (strcmp(config, "single_button_press_action") == 0 && this->single_button_press_action_select_ != nullptr) {
-            this->single_button_press_action_select_->publish_state(value);
-        } else if (strcmp(config, "double_button_press_action") == 0 && this->double_button_press_action_select_ != nullptr) {
-            this->double_button_press_action_select_->publish_state(value);
-        } else if (strcmp(config, "fob_action_1") == 0 && this->fob_action_1_select_ != nullptr) {
-            this->fob_action_1_select_->publish_state(value);
-        } else if (strcmp(config, "fob_action_2") == 0 && this->fob_action_2_select_ != nullptr) {
-            this->fob_action_2_select_->publish_state(value);
-        } else if (strcmp(config, "fob_action_3") == 0 && this->fob_action_3_select_ != nullptr) {
-            this->fob_action_3_select_->publish_state(value);
-        } else if (strcmp(config, "timezone") == 0 && this->timezone_select_ != nullptr) {
-            this->timezone_select_->publish_state(value);
-        } else if (strcmp(config, "advertising_mode") == 0 && this->advertising_mode_select_ != nullptr) {
-            this->advertising_mode_select_->publish_state(value);
-        } else if (!this->nuki_lock_.isLockUltra() && strcmp(config, "battery_type") == 0 && this->battery_type_select_ != nullptr) {
-            this->battery_type_select_->publish_state(value);
-        } else if (this->nuki_lock_.isLockUltra() && strcmp(config, "motor_speed") == 0 && this->motor_speed_select_ != nullptr) {
-            this->motor_speed_select_->publish_state(value);
+    bool has_config = false;
+    bool has_advanced_config = false;
+    for (const auto& change : changes) {
+        if (change.advanced) {
+            has_advanced_config = true;
+        } else {
+            has_config = true;
         }
-        
-        this->config_update_ = !is_advanced;
-        this->advanced_config_update_ = is_advanced;
+    }
+
+    // Apply all changes to a copy of the cached config and write it in one transaction. The whole
+    // config is written, so it is read first unless a status confirmed that nobody else (e.g. the app)
+    // changed it since it was read. The cache itself is updated on the main loop afterwards.
+    if (has_config) {
+        auto config = std::make_shared<NukiLock::Config>(this->config_);
+        const bool cached = this->config_valid_ && this->config_checked_;
+        this->submit_ble(TraceCall::ConfigWrite, [this, changes, config, cached]() {
+            if (!cached) {
+                Nuki::CmdResult result = this->nuki_lock_.requestConfig(config.get());
+                if (result != Nuki::CmdResult::Success) {
+                    return result;
+                }
+            }
+
+            for (const auto& change : changes) {
+                if (!change.advanced) {
+                    this->apply_config_change(change, config.get(), nullptr);
+                }
+            }
+
+            return this->nuki_lock_.setFromConfig(*config);
+        }, [this, changes, config, cached](Nuki::CmdResult result) {
+            if (result == Nuki::CmdResult::Success) {
+                this->config_ = *config;
+                if (!cached) {
+                    this->config_valid_ = true;
+                    this->config_checked_ = false;
+                }
+            }
+            this->complete_config_write(false, changes, result);
+        });
+    }
+
+    if (has_advanced_config) {
+        auto advanced_config = std::make_shared<NukiLock::AdvancedConfig>(this->advanced_config_);
+        const bool cached = this->advanced_config_valid_ && this->advanced_config_checked_;
+        this->submit_ble(TraceCall::ConfigWrite, [this, changes, advanced_config, cached]() {
+            if (!cached) {
+                Nuki::CmdResult result = this->nuki_lock_.requestAdvancedConfig(advanced_config.get());
+                if (result != Nuki::CmdResult::Success) {
+                    return result;
+                }
+            }
+
+            for (const auto& change : changes) {
+                if (change.advanced) {
+                    this->apply_config_change(change, nullptr, advanced_config.get());
+                }
+            }
+
+            return this->nuki_lock_.setFromAdvancedConfig(*advanced_config);
+        }, [this, changes, advanced_config, cached](Nuki::CmdResult result) {
+            if (result == Nuki::CmdResult::Success) {
+                this->advanced_config_ = *advanced_config;
+                if (!cached) {
+                    this->advanced_config_valid_ = true;
+                    this->advanced_config_checked_ = false;
+                }
+            }
+            this->complete_config_write(true, changes, result);
+        });
+    }
+}
+
+void NukiLockComponent::complete_config_write(bool advanced, const std::vector<ConfigChange> &changes, Nuki::CmdResult result) {
+    size_t written = 0;
+    for (const auto& change : changes) {
+        if (change.advanced != advanced) {
+            continue;
+        }
+
+        if (result == Nuki::CmdResult::Success) {
+            this->publish_config_change(change);
+            written++;
+        } else {
+            ESP_LOGE(TAG, "Saving setting %s failed (result %d)", this->config_change_name(change), result);
+        }
+    }
+
+    // Successful writes are confirmed by the next scheduled refresh, their config counter
+    // increments are expected. A failed write may have been based on a stale cache.
+    if (result == Nuki::CmdResult::Success) {
+        ESP_LOGI(TAG, "Wrote %u %s setting changes", written, advanced ? "advanced" : "basic");
+        this->own_config_updates_++;
+    } else if (advanced) {
+        this->advanced_config_valid_ = false;
+        this->scheduler_.request(CommandType::AdvancedConfig);
     } else {
-        ESP_LOGE(TAG, "Saving setting %s failed (result %d)", config, cmd_result);
+        this->config_valid_ = false;
+        this->scheduler_.request(CommandType::Config);
+    }
+    this->trigger_commands();
+}
+
+#ifdef USE_SELECT
+void NukiLockComponent::set_config_select(ConfigSelect setting, const char* value) {
+    const ConfigSelectDescriptor &descriptor = CONFIG_SELECTS[static_cast<size_t>(setting)];
+
+    if (!this->nuki_lock_.isPairedWithLock()) {
+        ESP_LOGE(TAG, "Lock is not paired, cannot change setting %s", descriptor.name);
+        return;
     }
+
+    if (!this->is_config_supported(descriptor.model)) {
+        ESP_LOGE(TAG, "Setting %s is not supported by this lock", descriptor.name);
+        return;
+    }
+
+    const int option = descriptor.to_value(this, value);
+    if (option < 0) {
+        ESP_LOGE(TAG, "Invalid value %s for setting %s", value, descriptor.name);
+        return;
+    }
+
+    this->queue_config_change({ConfigEntityType::Select, static_cast<uint8_t>(setting), descriptor.advanced, static_cast<float>(option)});
 }
 #endif
 
 #ifdef USE_SWITCH
-void NukiLockComponent::set_config_switch(const char* config, bool value) {
+void NukiLockComponent::set_config_switch(ConfigSwitch setting, bool value) {
+    const ConfigSwitchDescriptor &descriptor = CONFIG_SWITCHES[static_cast<size_t>(setting)];
+
     if (!this->nuki_lock_.isPairedWithLock()) {
-        ESP_LOGE(TAG, "Lock is not paired, cannot change setting %s", config);
-        return;
-    }
-
-    Nuki::CmdResult cmd_result = (Nuki::CmdResult)-1;
-    bool is_advanced = false;
-
-    // Update Config
-    if (strcmp(config, "pairing_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enablePairing(value);
-    } else if (strcmp(config, "auto_unlatch_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableAutoUnlatch(value);
-    } else if (strcmp(config, "button_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableButton(value);
-    } else if (strcmp(config, "led_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableLedFlash(value);
-    } else if (strcmp(config, "nightmode_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableNightMode(value);
-        is_advanced = true;
-    } else if (strcmp(config, "night_mode_auto_lock_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableNightModeAutoLock(value);
-        is_advanced = true;
-    } else if (strcmp(config, "night_mode_auto_unlock_disabled") == 0) {
-        cmd_result = this->nuki_lock_.disableNightModeAutoUnlock(value);
-        is_advanced = true;
-    } else if (strcmp(config, "night_mode_immediate_lock_on_start") == 0) {
-        cmd_result = this->nuki_lock_.enableNightModeImmediateLockOnStart(value);
-        is_advanced = true;
-    } else if (strcmp(config, "auto_lock_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableAutoLock(value);
-        is_advanced = true;
-    } else if (strcmp(config, "auto_unlock_disabled") == 0) {
-        cmd_result = this->nuki_lock_.disableAutoUnlock(value);
-        is_advanced = true;
-    } else if (strcmp(config, "immediate_auto_lock_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableImmediateAutoLock(value);
-        is_advanced = true;
-    } else if (strcmp(config, "auto_update_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableAutoUpdate(value);
-        is_advanced = true;
-    } else if (strcmp(config, "single_lock_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableSingleLock(value);
-    } else if (strcmp(config, "dst_mode_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableDst(value);
-    } else if (!this->nuki_lock_.isLockUltra() && strcmp(config, "auto_battery_type_detection_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableAutoBatteryTypeDetection(value);
-    } else if (this->nuki_lock_.isLockUltra() && strcmp(config, "slow_speed_during_night_mode_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableSlowSpeedDuringNightMode(value);
-    } else if (strcmp(config, "detached_cylinder_enabled") == 0) {
-        cmd_result = this->nuki_lock_.enableDetachedCylinder(value);
-    }
-
-    if (cmd_result == Nuki::CmdResult::Success)
-    {
-        if (strcmp(config, "pairing_enabled") == 0 && this->pairing_enabled_switch_ != nullptr) {
-            this->pairing_enabled_switch_->publish_state(value);
-        } else if (strcmp(config, "auto_unlatch_enabled") == 0 && this->auto_unlatch_enabled_switch_ != nullptr) {
-            this->auto_unlatch_enabled_switch_->publish_state(value);
-        } else if (strcmp(config, "button_enabled") == 0 && this->button_enabled_switch_ != nullptr) {
-            this->button_enabled_switch_->publish_state(value);
-        } else if (strcmp(config, "led_enabled") == 0 && this->led_enabled_switch_ != nullptr) {
-            this->led_enabled_switch_->publish_state(value);
-        } else if (strcmp(config, "nightmode_enabled") == 0 && this->nightmode_enabled_switch_ != nullptr) {
-            this->nightmode_enabled_switch_->publish_state(value);
-        } else if (strcmp(config, "night_mode_auto_lock_enabled") == 0 && this->night_mode_auto_lock_enabled_switch_ != nullptr) {
-            this->night_mode_auto_lock_enabled_switch_->publish_state(value);
-        } else if (strcmp(config, "night_mode_auto_unlock_disabled") == 0 && this->night_mode_auto_unlock_disabled_switch_ != nullptr) {
-            this->night_mode_auto_unlock_disabled_switch_->publish_state(value);
-        } else if (strcmp(config, "night_mode_immediate_lock_on_start") == 0 && this->night_mode_immediate_lock_on_start_switch_ != nullptr) {
-            this->night_mode_immediate_lock_on_start_switch_->publish_state(value);
-        } else if (strcmp(config, "auto_lock_enabled") == 0 && this->auto_lock_enabled_switch_ != nullptr) {
-            this->auto_lock_enabled_switch_->publish_state(value);
-        } else if (strcmp(config, "auto_unlock_disabled") == 0 && this->auto_unlock_disabled_switch_ != nullptr) {
-            this->auto_unlock_disabled_switch_->publish_state(value);
-        } else if (strcmp(config, "immediate_auto_lock_enabled") == 0 && this->immediate_auto_lock_enabled_switch_ != nullptr) {
-            this->immediate_auto_lock_enabled_switch_->publish_state(value);
-        } else if (strcmp(config, "auto_update_enabled") == 0 && this->auto_update_enabled_switch_ != nullptr) {
-            this->auto_update_enabled_switch_->publish_state(value);
-        } else if (strcmp(config, "single_lock_enabled") == 0 && this->single_lock_enabled_switch_ != nullptr) {
-            this->single_lock_enabled_switch_->publish_state(value);
-        } else if (strcmp(config, "dst_mode_enabled") == 0 && this->dst_mode_enabled_switch_ != nullptr) {
-            this->dst_mode_enabled_switch_->publish_state(value);
-        } else if (!this->nuki_lock_.isLockUltra() && strcmp(config, "auto_battery_type_detection_enabled") == 0 && this->auto_battery_type_detection_enabled_switch_ != nullptr) {
-            this->auto_battery_type_detection_enabled_switch_->publish_state(value);
-        } else if (this->nuki_lock_.isLockUltra() && strcmp(config, "slow_speed_during_night_mode_enabled") == 0 && this->slow_speed_during_night_mode_enabled_switch_ != nullptr) {
-            this->slow_speed_during_night_mode_enabled_switch_->publish_state(value);
-        } else if (strcmp(config, "detached_cylinder_enabled") == 0 && this->detached_cylinder_enabled_switch_ != nullptr) {
-            this->detached_cylinder_enabled_switch_->publish_state(value);
-        }
-
-        this->config_update_ = !is_advanced;
-        this->advanced_config_update_ = is_advanced;
-    } else {
-        ESP_LOGE(TAG, "Saving setting %s failed (result %d)", config, cmd_result);
+        ESP_LOGE(TAG, "Lock is not paired, cannot change setting %s", descriptor.name);
+        return;
+    }
+
+    if (!this->is_config_supported(descriptor.model)) {
+        ESP_LOGE(TAG, "Setting %s is not supported by this lock", descriptor.name);
+        return;
     }
+
+    this->queue_config_change({ConfigEntityType::Switch, static_cast<uint8_t>(setting), descriptor.advanced, value ? 1.0f : 0.0f});
 }
 #endif
 #ifdef USE_NUMBER
-void NukiLockComponent::set_config_number(const char* config, float value) {
+void NukiLockComponent::set_config_number(ConfigNumber setting, float value) {
+    const ConfigNumberDescriptor &descriptor = CONFIG_NUMBERS[static_cast<size_t>(setting)];
+
     if (!this->nuki_lock_.isPairedWithLock()) {
-        ESP_LOGE(TAG, "Lock is not paired, cannot change setting %s", config);
+        ESP_LOGE(TAG, "Lock is not paired, cannot change setting %s", descriptor.name);
         return;
     }
 
-    Nuki::CmdResult cmd_result = (Nuki::CmdResult)-1;
-    bool is_advanced = false;
-
-    // Update Config
-    if (strcmp(config, "led_brightness") == 0) {
-        cmd_result = this->nuki_lock_.setLedBrightness(value);
-    } else if (strcmp(config, "timezone_offset") == 0) {
-        if (value >= -60 && value <= 60) {
-            cmd_result = this->nuki_lock_.setTimeZoneOffset(value);
-        }
-    } else if (strcmp(config, "lock_n_go_timeout") == 0) {
-        if (value >= 5 && value <= 60) {
-            cmd_result = this->nuki_lock_.setLockNgoTimeout(value);
-            is_advanced = true;
-        }
-    } else if (strcmp(config, "auto_lock_timeout") == 0) {
-        if (value >= 30 && value <= 1800) {
-            cmd_result = this->nuki_lock_.setAutoLockTimeOut(value);
-            is_advanced = true;
-        }
-    } else if (strcmp(config, "unlatch_duration") == 0) {
-        if (value >= 1 && value <= 30) {
-            cmd_result = this->nuki_lock_.setUnlatchDuration(value);
-            is_advanced = true;
-        }
-    } else if (strcmp(config, "unlocked_position_offset") == 0) {
-        if (value >= -90 && value <= 180) {
-            cmd_result = this->nuki_lock_.setUnlockedPositionOffsetDegrees(value);
-            is_advanced = true;
-        }
-    } else if (strcmp(config, "locked_position_offset") == 0) {
-        if (value >= -180 && value <= 90) {
-            cmd_result = this->nuki_lock_.setLockedPositionOffsetDegrees(value);
-            is_advanced = true;
-        }
-    } else if (strcmp(config, "single_locked_position_offset") == 0) {
-        if (value >= -180 && value <= 180) {
-            cmd_result = this->nuki_lock_.setSingleLockedPositionOffsetDegrees(value);
-            is_advanced = true;
-        }
-    } else if (strcmp(config, "unlocked_to_locked_transition_offset") == 0) {
-        if (value >= -180 && value <= 180) {
-            cmd_result = this->nuki_lock_.setUnlockedToLockedTransitionOffsetDegrees(value);
-            is_advanced = true;
-        }
+    if (!this->is_config_supported(descriptor.model)) {
+        ESP_LOGE(TAG, "Setting %s is not supported by this lock", descriptor.name);
+        return;
     }
 
-    if (cmd_result == Nuki::CmdResult::Success) {
-        if (strcmp(config, "led_brightness") == 0 && this->led_brightness_number_ != nullptr) {
-            this->led_brightness_number_->publish_state(value);
-        } else if (strcmp(config, "timezone_offset") == 0 && this->timezone_offset_number_ != nullptr) {
-            this->timezone_offset_number_->publish_state(value);
-        } else if (strcmp(config, "lock_n_go_timeout") == 0 && this->lock_n_go_timeout_number_ != nullptr) {
-            this->lock_n_go_timeout_number_->publish_state(value);
-        } else if (strcmp(config, "auto_lock_timeout") == 0 && this->auto_lock_timeout_number_ != nullptr) {
-            this->auto_lock_timeout_number_->publish_state(value);
-        } else if (strcmp(config, "unlatch_duration") == 0 && this->unlatch_duration_number_ != nullptr) {
-            this->unlatch_duration_number_->publish_state(value);
-        } else if (strcmp(config, "unlocked_position_offset") == 0 && this->unlocked_position_offset_number_ != nullptr) {
-            this->unlocked_position_offset_number_->publish_state(value);
-        } else if (strcmp(config, "locked_position_offset") == 0 && this->locked_position_offset_number_ != nullptr) {
-            this->locked_position_offset_number_->publish_state(value);
-        } else if (strcmp(config, "single_locked_position_offset") == 0 && this->single_locked_position_offset_number_ != nullptr) {
-            this->single_locked_position_offset_number_->publish_state(value);
-        } else if (strcmp(config, "unlocked_to_locked_transition_offset") == 0 && this->unlocked_to_locked_transition_offset_number_ != nullptr) {
-            this->unlocked_to_locked_transition_offset_number_->publish_state(value);
-        }
-        
-        this->config_update_ = !is_advanced;
-        this->advanced_config_update_ = is_advanced;
-    } else {
-        ESP_LOGE(TAG, "Saving setting %s failed (result %d)", config, cmd_result);
+    if (value < descriptor.min_value || value > descriptor.max_value) {
+        ESP_LOGE(TAG, "Value %.0f for setting %s is out of range (%.0f to %.0f)", value, descriptor.name, descriptor.min_value, descriptor.max_value);
+        return;
     }
+
+    this->queue_config_change({ConfigEntityType::Number, static_cast<uint8_t>(setting), descriptor.advanced, value});
 }
 #endif
 
@@ -2291,39 +3772,39 @@ void NukiLockRequestCalibrationButton::press_action() {
 #endif
 #ifdef USE_SELECT
 void NukiLockSingleButtonPressActionSelect::control(const std::string &action) {
-    this->parent_->set_config_select("single_button_press_action", action.c_str());
+    this->parent_->set_config_select(ConfigSelect::SingleButtonPressAction, action.c_str());
 }
 
 void NukiLockDoubleButtonPressActionSelect::control(const std::string &action) {
-    this->parent_->set_config_select("double_button_press_action", action.c_str());
+    this->parent_->set_config_select(ConfigSelect::DoubleButtonPressAction, action.c_str());
 }
 
 void NukiLockFobAction1Select::control(const std::string &action) {
-    this->parent_->set_config_select("fob_action_1", action.c_str());
+    this->parent_->set_config_select(ConfigSelect::FobAction1, action.c_str());
 }
 
 void NukiLockFobAction2Select::control(const std::string &action) {
-    this->parent_->set_config_select("fob_action_2", action.c_str());
+    this->parent_->set_config_select(ConfigSelect::FobAction2, action.c_str());
 }
 
 void NukiLockFobAction3Select::control(const std::string &action) {
-    this->parent_->set_config_select("fob_action_3", action.c_str());
+    this->parent_->set_config_select(ConfigSelect::FobAction3, action.c_str());
 }
 
 void NukiLockTimeZoneSelect::control(const std::string &zone) {
-    this->parent_->set_config_select("timezone", zone.c_str());
+    this->parent_->set_config_select(ConfigSelect::Timezone, zone.c_str());
 }
 
 void NukiLockAdvertisingModeSelect::control(const std::string &mode) {
-    this->parent_->set_config_select("advertising_mode", mode.c_str());
+    this->parent_->set_config_select(ConfigSelect::AdvertisingMode, mode.c_str());
 }
 
 void NukiLockBatteryTypeSelect::control(const std::string &mode) {
-    this->parent_->set_config_select("battery_type", mode.c_str());
+    this->parent_->set_config_select(ConfigSelect::BatteryType, mode.c_str());
 }
 
 void NukiLockMotorSpeedSelect::control(const std::string &mode) {
-    this->parent_->set_config_select("motor_speed", mode.c_str());
+    this->parent_->set_config_select(ConfigSelect::MotorSpeed, mode.c_str());
 }
 #endif
 #ifdef USE_SWITCH
@@ -2332,99 +3813,99 @@ void NukiLockPairingModeSwitch::write_state(bool state) {
 }
 
 void NukiLockPairingEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("pairing_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::PairingEnabled, state);
 }
 
 void NukiLockAutoUnlatchEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("auto_unlatch_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::AutoUnlatchEnabled, state);
 }
 
 void NukiLockButtonEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("button_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::ButtonEnabled, state);
 }
 
 void NukiLockLedEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("led_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::LedEnabled, state);
 }
 
 void NukiLockNightModeEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("nightmode_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::NightModeEnabled, state);
 }
 
 void NukiLockNightModeAutoLockEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("night_mode_auto_lock_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::NightModeAutoLockEnabled, state);
 }
 
 void NukiLockNightModeAutoUnlockDisabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("night_mode_auto_unlock_disabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::NightModeAutoUnlockDisabled, state);
 }
 
 void NukiLockNightModeImmediateLockOnStartEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("night_mode_immediate_lock_on_start", state);
+    this->parent_->set_config_switch(ConfigSwitch::NightModeImmediateLockOnStart, state);
 }
 
 void NukiLockAutoLockEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("auto_lock_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::AutoLockEnabled, state);
 }
 
 void NukiLockAutoUnlockDisabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("auto_unlock_disabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::AutoUnlockDisabled, state);
 }
 
 void NukiLockImmediateAutoLockEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("immediate_auto_lock_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::ImmediateAutoLockEnabled, state);
 }
 
 void NukiLockAutoUpdateEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("auto_update_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::AutoUpdateEnabled, state);
 }
 
 void NukiLockSingleLockEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("single_lock_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::SingleLockEnabled, state);
 }
 
 void NukiLockDstModeEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("dst_mode_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::DstModeEnabled, state);
 }
 
 void NukiLockAutoBatteryTypeDetectionEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("auto_battery_type_detection_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::AutoBatteryTypeDetectionEnabled, state);
 }
 
 void NukiLockSlowSpeedDuringNightModeEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("slow_speed_during_night_mode_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::SlowSpeedDuringNightModeEnabled, state);
 }
 void NukiLockDetachedCylinderEnabledSwitch::write_state(bool state) {
-    this->parent_->set_config_switch("detached_cylinder_enabled", state);
+    this->parent_->set_config_switch(ConfigSwitch::DetachedCylinderEnabled, state);
 }
 #endif
 #ifdef USE_NUMBER
 void NukiLockLedBrightnessNumber::control(float value) {
-    this->parent_->set_config_number("led_brightness", value);
+    this->parent_->set_config_number(ConfigNumber::LedBrightness, value);
 }
 void NukiLockTimeZoneOffsetNumber::control(float value) {
-    this->parent_->set_config_number("timezone_offset", value);
+    this->parent_->set_config_number(ConfigNumber::TimezoneOffset, value);
 }
 void NukiLockLockNGoTimeoutNumber::control(float value) {
-    this->parent_->set_config_number("lock_n_go_timeout", value);
+    this->parent_->set_config_number(ConfigNumber::LockNGoTimeout, value);
 }
 void NukiLockAutoLockTimeoutNumber::control(float value) {
-    this->parent_->set_config_number("auto_lock_timeout", value);
+    this->parent_->set_config_number(ConfigNumber::AutoLockTimeout, value);
 }
 void NukiLockUnlatchDurationNumber::control(float value) {
-    this->parent_->set_config_number("unlatch_duration", value);
+    this->parent_->set_config_number(ConfigNumber::UnlatchDuration, value);
 }
 void NukiLockUnlockedPositionOffsetDegreesNumber::control(float value) {
-    this->parent_->set_config_number("unlocked_position_offset", value);
+    this->parent_->set_config_number(ConfigNumber::UnlockedPositionOffset, value);
 }
 void NukiLockLockedPositionOffsetDegreesNumber::control(float value) {
-    this->parent_->set_config_number("locked_position_offset", value);
+    this->parent_->set_config_number(ConfigNumber::LockedPositionOffset, value);
 }
 void NukiLockSingleLockedPositionOffsetDegreesNumber::control(float value) {
-    this->parent_->set_config_number("single_locked_position_offset", value);
+    this->parent_->set_config_number(ConfigNumber::SingleLockedPositionOffset, value);
 }
 void NukiLockUnlockedToLockedTransitionOffsetDegreesNumber::control(float value) {
-    this->parent_->set_config_number("unlocked_to_locked_transition_offset", value);
+    this->parent_->set_config_number(ConfigNumber::UnlockedToLockedTransitionOffset, value);
 }
 #endif
 
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <list>
 #include <map>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 
 #include "esphome/core/component.h"
@@ -38,27 +43,68 @@
 #include "NukiConstants.h"
 #include "BleScanner.h"
 
+#include "beacon_detector.h"
+#include "ble_worker.h"
+#include "command_scheduler.h"
+#include "command_trace.h"
+#include "cooldown_estimator.h"
+#include "event_payload.h"
+#include "auth_index.h"
+#include "keypad_cache.h"
+
 namespace esphome {
 namespace nuki_lock {
 
-static const char *TAG = "nuki_lock.lock";
-
 static const uint8_t BLE_CONNECT_TIMEOUT_SEC = 2;
 static const uint8_t BLE_CONNECT_RETRIES = 5;
 
 static const uint16_t BLE_DISCONNECT_TIMEOUT = 2000;
 
+// Sessions keep the connection open between their commands and close it once all completed
+static const uint16_t BLE_SESSION_DISCONNECT_TIMEOUT = 5000;
+static const uint32_t BLE_SESSION_TIMEOUT_MILLIS = 30000;
+
+// Without BLE activity the connection is down and the scan keeps running, update() only
+// checks the scanner at this interval to restart a scan that ended
+static const uint32_t BLE_IDLE_SCANNER_UPDATE_MILLIS = 10000;
+
 static const uint8_t MAX_ACTION_ATTEMPTS = 5;
 static const uint8_t MAX_TOLERATED_UPDATES_ERRORS = 5;
 
-static const uint32_t COOLDOWN_COMMANDS_MILLIS = 1000;
-static const uint32_t COOLDOWN_COMMANDS_EXTENDED_MILLIS = 3000;
-
-static const uint8_t MAX_AUTH_DATA_ENTRIES = 10;
+// Maximum time a background refresh may wait before it is forced ahead of other refreshes
+static const uint32_t DEADLINE_STATUS_MILLIS = 10000;
+static const uint32_t DEADLINE_CONFIG_MILLIS = 60000;
+static const uint32_t DEADLINE_ADVANCED_CONFIG_MILLIS = 60000;
+static const uint32_t DEADLINE_AUTH_DATA_MILLIS = 120000;
+static const uint32_t DEADLINE_EVENT_LOG_MILLIS = 30000;
+static const uint32_t DEADLINE_KEYPAD_DATA_MILLIS = 120000;
+static const uint32_t DEADLINE_KEYPAD_WRITE_MILLIS = 30000;
+
+// Authorization entries requested per page, the index is filled over several requests
+static const uint8_t AUTH_DATA_PAGE_SIZE = 10;
+// The probe requests the last known entry and the one after it
+static const uint8_t AUTH_DATA_PROBE_SIZE = 2;
+// Keypad codes requested per page
+static const uint8_t KEYPAD_DATA_PAGE_SIZE = 10;
+// Keypad operations that can be queued at once
+static const uint8_t KEYPAD_BATCH_MAX_OPERATIONS = 100;
+// Settings changed within this window are written together
+static const uint32_t CONFIG_WRITE_DELAY_MILLIS = 250;
 static const uint8_t MAX_EVENT_LOG_ENTRIES = 3;
+// Entries requested per catch-up page once the event log cursor is known
+static const uint8_t EVENT_LOG_PAGE_SIZE = 10;
 
 static const uint8_t MAX_NAME_LEN = 32;
 
+// A result is complete once the expected entries arrived or no entry came in for this long,
+// which includes a successful request that returned no entries at all
+static const uint32_t RESULT_SETTLE_MILLIS = 500;
+// Received auth data and log entries are checked this often until the result is complete.
+// Each check copies the list from the library, twice per settle window is enough.
+static const uint32_t RESULT_POLL_INTERVAL_MILLIS = RESULT_SETTLE_MILLIS / 2;
+// Fallback if entries keep trickling in
+static const uint32_t RESULT_TIMEOUT_MILLIS = 5000;
+
 enum PinState
 {
     NotSet = 0,
@@ -67,9 +113,164 @@ enum PinState
     Invalid = 3
 };
 
-struct AuthEntry {
-    uint32_t authId;
-    char name[MAX_NAME_LEN];
+enum class KeypadOperationType : uint8_t
+{
+    Add = 0,
+    Update,
+    Delete
+};
+
+struct KeypadOperation
+{
+    KeypadOperationType type;
+    // Position in the batch, used when reporting the result
+    uint16_t index;
+    uint16_t id;
+    uint32_t code;
+    bool enabled;
+    char name[KEYPAD_NAME_LEN + 1];
+};
+
+class NukiLockComponent;
+
+// Lock models a setting is available on
+enum class ConfigModel : uint8_t
+{
+    Any = 0,
+    NonUltra,
+    Ultra
+};
+
+enum class ConfigEntityType : uint8_t
+{
+    Switch = 0,
+    Number,
+    Select
+};
+
+// Indexes into NukiLockComponent::CONFIG_SWITCHES
+enum class ConfigSwitch : uint8_t
+{
+    PairingEnabled = 0,
+    AutoUnlatchEnabled,
+    ButtonEnabled,
+    LedEnabled,
+    NightModeEnabled,
+    NightModeAutoLockEnabled,
+    NightModeAutoUnlockDisabled,
+    NightModeImmediateLockOnStart,
+    AutoLockEnabled,
+    AutoUnlockDisabled,
+    ImmediateAutoLockEnabled,
+    AutoUpdateEnabled,
+    SingleLockEnabled,
+    DstModeEnabled,
+    AutoBatteryTypeDetectionEnabled,
+    SlowSpeedDuringNightModeEnabled,
+    DetachedCylinderEnabled,
+    Count
+};
+
+// Indexes into NukiLockComponent::CONFIG_NUMBERS
+enum class ConfigNumber : uint8_t
+{
+    LedBrightness = 0,
+    TimezoneOffset,
+    LockNGoTimeout,
+    AutoLockTimeout,
+    UnlatchDuration,
+    UnlockedPositionOffset,
+    LockedPositionOffset,
+    SingleLockedPositionOffset,
+    UnlockedToLockedTransitionOffset,
+    Count
+};
+
+// Indexes into NukiLockComponent::CONFIG_SELECTS
+enum class ConfigSelect : uint8_t
+{
+    SingleButtonPressAction = 0,
+    DoubleButtonPressAction,
+    FobAction1,
+    FobAction2,
+    FobAction3,
+    Timezone,
+    AdvertisingMode,
+    BatteryType,
+    MotorSpeed,
+    Count
+};
+
+/*
+ * Setting descriptors. A setting lives either in the Config or in the AdvancedConfig,
+ * only the accessors of that struct are set.
+ */
+#ifdef USE_SWITCH
+struct ConfigSwitchDescriptor
+{
+    const char *name;
+    const char *label;
+    ConfigModel model;
+    bool advanced;
+    switch_::Switch *NukiLockComponent::*entity;
+    bool (*get_config)(const NukiLock::Config &config);
+    void (*set_config)(NukiLock::Config &config, bool value);
+    bool (*get_advanced_config)(const NukiLock::AdvancedConfig &advanced_config);
+    void (*set_advanced_config)(NukiLock::AdvancedConfig &advanced_config, bool value);
+};
+#endif
+
+#ifdef USE_NUMBER
+struct ConfigNumberDescriptor
+{
+    const char *name;
+    const char *label;
+    ConfigModel model;
+    bool advanced;
+    number::Number *NukiLockComponent::*entity;
+    float min_value;
+    float max_value;
+    float (*get_config)(const NukiLock::Config &config);
+    void (*set_config)(NukiLock::Config &config, float value);
+    float (*get_advanced_config)(const NukiLock::AdvancedConfig &advanced_config);
+    void (*set_advanced_config)(NukiLock::AdvancedConfig &advanced_config, float value);
+};
+#endif
+
+#ifdef USE_SELECT
+struct ConfigSelectDescriptor
+{
+    const char *name;
+    const char *label;
+    ConfigModel model;
+    bool advanced;
+    select::Select *NukiLockComponent::*entity;
+    // Converts between options and values, to_value returns -1 for unknown options
+    int (*to_value)(NukiLockComponent *parent, const char *option);
+    void (*to_string)(NukiLockComponent *parent, int value, char *str);
+    int (*get_config)(const NukiLock::Config &config);
+    void (*set_config)(NukiLock::Config &config, int value);
+    int (*get_advanced_config)(const NukiLock::AdvancedConfig &advanced_config);
+    void (*set_advanced_config)(NukiLock::AdvancedConfig &advanced_config, int value);
+};
+#endif
+
+// Setting change waiting for the coalesced config write
+struct ConfigChange
+{
+    ConfigEntityType type;
+    uint8_t index;
+    bool advanced;
+    // Switch state, number or select value
+    float value;
+};
+
+// Desired keypad code, see keypad_codes
+struct KeypadCode
+{
+    std::string name;
+    uint32_t code;
+    bool enabled;
 };
 
 struct NukiLockSettings
@@ -78,6 +279,72 @@ struct NukiLockSettings
     PinState pin_state;
 };
 
+// Tracks the entries of a list command, they arrive one by one after the request succeeded
+struct ResultProgress
+{
+    uint32_t started = 0;
+    uint32_t last_change = 0;
+    uint32_t elapsed = 0;
+    size_t count = 0;
+    size_t expected = 0;
+    bool timed_out = false;
+
+    void begin(size_t expected, uint32_t now);
+    // Returns true once all entries arrived, they stopped coming in or the wait timed out
+    bool update(size_t count, uint32_t now);
+};
+
+// Statistics of the list results of one command type
+struct ResultWait
+{
+    uint32_t completed = 0;
+    uint32_t timeouts = 0;
+    uint32_t last_millis = 0;
+    uint32_t max_millis = 0;
+};
+
+/**
+ * @brief Parameters and results of one scheduled command.
+ *
+ * Filled on the main loop, handed to the BLE worker with the job and returned through
+ * the completion queue. The worker never reads or writes the component state itself.
+ */
+struct CommandData
+{
+    // Parameters
+    NukiLock::LockAction lock_action;
+    KeypadOperation keypad_operation;
+    uint32_t start_index = 0;
+    uint16_t offset = 0;
+    uint16_t count = 0;
+
+    // Results
+    uint32_t started = 0;
+    uint32_t duration_millis = 0;
+    NukiLock::KeyTurnerState key_turner_state;
+    NukiLock::Config config;
+    NukiLock::AdvancedConfig advanced_config;
+    // Refilled from the library on every check until complete, see NukiLockComponent::collect_entries()
+    ResultProgress progress;
+    std::list<NukiLock::AuthorizationEntry> auth_entries;
+    std::list<NukiLock::LogEntry> log_entries;
+    std::list<NukiLock::KeypadEntry> keypad_entries;
+};
+
+// Bump when the layout of NukiLockCache changes, older records are ignored
+static const uint8_t CACHE_VERSION = 3;
+// Changes within this window are written to flash at once
+static const uint32_t CACHE_SAVE_DELAY_MILLIS = 30000;
+
+// Restored on boot to resume the event log and resolve user names without BLE
+struct NukiLockCache
+{
+    uint8_t version;
+    uint32_t last_rolling_log_id;
+    AuthIndexSnapshot auth_index;
+    KeypadCacheSnapshot keypad;
+};
+
 class NukiLockComponent :
     public lock::Lock,
     public PollingComponent,
@@ -95,6 +362,13 @@ class NukiLockComponent :
     #ifdef USE_SENSOR
     SUB_SENSOR(battery_level)
     SUB_SENSOR(bt_signal)
+    SUB_SENSOR(status_cooldown)
+    SUB_SENSOR(lock_action_cooldown)
+    SUB_SENSOR(lock_action_delay)
+    SUB_SENSOR(connects_saved)
+    SUB_SENSOR(lock_action_latency)
+    SUB_SENSOR(status_queries_avoided)
+    SUB_SENSOR(ble_commands)
     #endif
     #ifdef USE_TEXT_SENSOR
     SUB_TEXT_SENSOR(door_sensor_state)
@@ -164,7 +438,9 @@ class NukiLockComponent :
 
         void setup() override;
         void update() override;
+        void loop() override;
         void dump_config() override;
+        void on_safe_shutdown() override;
         void notify(Nuki::EventType event_type) override;
         float get_setup_priority() const override { return setup_priority::HARDWARE; }
 
@@ -173,6 +449,13 @@ class NukiLockComponent :
         void set_query_interval_auth_data(uint32_t query_interval_auth_data) { this->query_interval_auth_data_ = query_interval_auth_data; }
         void set_ble_general_timeout(uint32_t ble_general_timeout) { this->ble_general_timeout_ = ble_general_timeout; }
         void set_ble_command_timeout(uint32_t ble_command_timeout) { this->ble_command_timeout_ = ble_command_timeout; }
+        void set_async_commands(bool async_commands) { this->async_commands_ = async_commands; }
+        void set_event_driven(bool event_driven) { this->event_driven_ = event_driven; }
+        void add_keypad_code(const std::string &name, uint32_t code, bool enabled) { this->keypad_codes_.push_back({name, code, enabled}); }
+        void set_keypad_codes_exclusive(bool exclusive) { this->keypad_codes_exclusive_ = exclusive; }
+        void set_transition_poll_interval(uint32_t transition_poll_interval) { this->transition_poll_interval_ = transition_poll_interval; }
+        void set_transition_poll_backoff(float transition_poll_backoff) { this->transition_poll_backoff_ = transition_poll_backoff; }
+        void set_transition_poll_max(uint8_t transition_poll_max) { this->transition_poll_max_ = transition_poll_max; }
         void set_event(const char *event) {
             this->event_ = event;
             if(strcmp(event, "esphome.none") != 0) {
@@ -222,6 +505,9 @@ class NukiLockComponent :
         void unpair();
         void set_pairing_mode(bool enabled);
         void save_settings();
+        void load_cache();
+        void save_cache();
+        void schedule_cache_save();
 
         void request_calibration();
 
@@ -234,56 +520,181 @@ class NukiLockComponent :
         }
 
         #ifdef USE_NUMBER
-        void set_config_number(const char* config, float value);
+        void set_config_number(ConfigNumber setting, float value);
         #endif
         #ifdef USE_SWITCH
-        void set_config_switch(const char* config, bool value);
+        void set_config_switch(ConfigSwitch setting, bool value);
+        #endif
+        #ifdef USE_SELECT
+        void set_config_select(ConfigSelect setting, const char* value);
+        #endif
+
+        // Setting tables, indexed by ConfigSwitch, ConfigNumber and ConfigSelect
+        #ifdef USE_SWITCH
+        static const ConfigSwitchDescriptor CONFIG_SWITCHES[];
+        #endif
+        #ifdef USE_NUMBER
+        static const ConfigNumberDescriptor CONFIG_NUMBERS[];
         #endif
         #ifdef USE_SELECT
-        void set_config_select(const char* config, const char* value);
+        static const ConfigSelectDescriptor CONFIG_SELECTS[];
         #endif
 
     protected:
         void control(const lock::LockCall &call) override;
         void open_latch() override { this->open_latch_ = true; unlock();}
 
-        void update_status();
-        void update_config();
-        void update_advanced_config();
-
-        void update_event_logs();
-        void update_auth_data();
+        void process_commands();
+        void trigger_commands();
+        void run_command(CommandType command);
+        Nuki::CmdResult execute_command(CommandType command, CommandData *data);
+        void complete_command(CommandType command, Nuki::CmdResult result, CommandData &data);
+        void skip_command(CommandType command);
+        void finish_session_command(CommandType command, bool done);
+        Nuki::CmdResult execute_ble(TraceCall call, std::function<Nuki::CmdResult()> &&execute);
+        void submit_ble(TraceCall call, std::function<Nuki::CmdResult()> &&execute,
+                        std::function<void(Nuki::CmdResult result)> &&complete = nullptr);
+        void call_ble(std::function<void()> &&call);
+        bool submit_call_ble(const std::function<void()> &call);
+        void flush_ble_calls();
+
+        void queue_config_change(ConfigChange &&change);
+        void write_config_changes();
+        void complete_config_write(bool advanced, const std::vector<ConfigChange> &changes, Nuki::CmdResult result);
+        void check_config_update_count(uint8_t config_update_count);
+        bool is_config_supported(ConfigModel model);
+        const char *config_change_name(const ConfigChange &change);
+        void apply_config_change(const ConfigChange &change, NukiLock::Config *config, NukiLock::AdvancedConfig *advanced_config);
+        void publish_config_change(const ConfigChange &change);
+        void publish_config_settings(bool advanced);
+
+        void start_session(std::initializer_list<CommandType> commands);
+        void open_session();
+        void end_session();
+        void piggyback_pending_commands();
+
+        bool handle_status_result(Nuki::CmdResult cmd_result);
+        bool handle_config_result(Nuki::CmdResult conf_req_result);
+        bool handle_advanced_config_result(Nuki::CmdResult conf_req_result);
+        bool handle_lock_action_result(Nuki::CmdResult result);
+
+        bool handle_event_log_result(Nuki::CmdResult event_log_req_result, std::list<NukiLock::LogEntry>& log);
+        bool handle_auth_data_result(Nuki::CmdResult auth_data_req_result, std::list<NukiLock::AuthorizationEntry>& authEntries);
+        bool handle_keypad_data_result(Nuki::CmdResult keypad_data_req_result, const std::list<NukiLock::KeypadEntry>& entries);
+        bool handle_keypad_write_result(Nuki::CmdResult keypad_write_result);
+        Nuki::CmdResult execute_keypad_operation(const KeypadOperation &operation);
+        void process_log_page(std::list<NukiLock::LogEntry>& log);
         void process_log_entries(const std::list<NukiLock::LogEntry>& log_entries);
+        void process_auth_entries(std::list<NukiLock::AuthorizationEntry>& authEntries);
+        void process_keypad_entries(const std::list<NukiLock::KeypadEntry>& entries);
 
         const char* get_auth_name(uint32_t authId) const;
-
+        static bool is_list_command(CommandType command);
+        size_t copy_entries(CommandType command, CommandData *data);
+        void collect_entries(CommandType command, CommandData *data);
+        void poll_entries(CommandType command, std::shared_ptr<CommandData> data);
+        void record_result_wait(CommandType command, const ResultProgress &progress);
+        void request_auth_data_refresh(const char *reason);
+        void check_auth_data_changed(const NukiLock::LogEntry& log);
+
+        void setup_scheduler();
         void setup_intervals(bool setup = true);
         void publish_pin_state();
 
         void validate_pin();
 
-        bool execute_lock_action(NukiLock::LockAction lock_action);
+        void publish_transitional_state(NukiLock::LockAction lock_action);
+
+        void process_events();
+        void handle_event(Nuki::EventType event_type);
+
+        LockModel get_lock_model() { return this->nuki_lock_.isLockUltra() ? LockModel::Ultra : LockModel::Gen1To4; }
+        void update_cooldown(CommandType command, bool success, uint32_t latency_millis);
+        void publish_cooldown_sensors();
+        void count_ble_command(bool success);
+        bool is_ble_idle();
+        void record_action_delay();
+        void record_action_latency(lock::LockState state);
+        uint32_t get_transition_poll_gap() const;
 
         BleScanner::Scanner scanner_;
+        BleWorker ble_worker_;
+        // Library calls the worker refused, retried in order from loop()
+        std::deque<std::function<void()>> pending_ble_calls_;
+        BeaconChangeDetector beacon_detector_;
+        CommandScheduler scheduler_;
+        CooldownEstimator cooldown_estimator_;
+        CommandTrace command_trace_;
         NukiLock::KeyTurnerState retrieved_key_turner_state_;
+        NukiLock::Config config_;
+        NukiLock::AdvancedConfig advanced_config_;
+        // Set once the cached config was read, patched in place by config writes
+        bool config_valid_ = false;
+        bool advanced_config_valid_ = false;
+        // Set once a status confirmed the config counter after the cached config was read
+        bool config_checked_ = false;
+        bool advanced_config_checked_ = false;
+        uint8_t config_update_count_ = 0;
+        bool config_update_count_valid_ = false;
+        uint8_t own_config_updates_ = 0;
         NukiLock::LockAction lock_action_;
-
-        AuthEntry auth_entries_[MAX_AUTH_DATA_ENTRIES];
-        size_t auth_entries_count_ = 0;
+        NukiLock::LockAction executing_lock_action_;
+
+        AuthIndex auth_index_;
+        // Offset of the next auth data page, 0 starts a new refresh
+        uint16_t auth_data_offset_ = 0;
+        // Set when the event log or a probe indicates changed authorizations
+        bool auth_data_refresh_ = false;
+        bool auth_data_probe_ = false;
+        uint32_t auth_data_probes_ = 0;
+        uint32_t auth_data_refreshes_ = 0;
+
+        ResultWait auth_data_wait_;
+        ResultWait event_log_wait_;
+        ResultWait keypad_data_wait_;
+        // Set while the entries of a list command are polled from the main loop, without the worker
+        bool polling_entries_ = false;
 
         uint32_t auth_id_ = 0;
         char auth_name_[33] = {0};
 
         uint32_t last_command_executed_time_ = 0;
+        // Last BLE transaction of any kind, the library may keep its connection open for a while after it
+        uint32_t last_ble_activity_time_ = 0;
+        uint32_t last_scanner_update_time_ = 0;
         uint32_t command_cooldown_millis = 0;
+        CommandType cooldown_command_ = CommandType::Status;
+        uint32_t cooldown_preemptions_ = 0;
+
+        // Commands of the requested session that did not complete yet, one bit per CommandType
+        uint8_t session_commands_ = 0;
+        static_assert(COMMAND_TYPE_COUNT <= 8, "session_commands_ has one bit per CommandType");
+        bool session_open_ = false;
+        uint32_t session_started_time_ = 0;
+        uint32_t session_progress_time_ = 0;
+        uint8_t session_completed_ = 0;
+        uint32_t sessions_ = 0;
+        uint32_t connects_saved_ = 0;
+        uint32_t piggybacked_commands_ = 0;
+
         uint8_t action_attempts_ = 0;
+        uint32_t action_requested_time_ = 0;
+        bool action_delay_pending_ = false;
+        bool action_latency_pending_ = false;
+        lock::LockState action_target_state_ = lock::LOCK_STATE_NONE;
+
+        // Status polls while the lock reports a transition, start with a short gap and back off
+        uint32_t transition_poll_interval_ = 250;
+        float transition_poll_backoff_ = 1.5f;
+        uint8_t transition_poll_max_ = 8;
+        uint8_t transition_polls_ = 0;
         uint32_t status_update_consecutive_errors_ = 0;
+        uint32_t status_queries_avoided_ = 0;
+
+        // BLE transactions issued to the lock (scheduled and one-off)
+        uint32_t ble_commands_ = 0;
+        uint32_t ble_command_errors_ = 0;
 
-        bool status_update_;
-        bool config_update_;
-        bool advanced_config_update_;
-        bool auth_data_update_;
-        bool event_log_update_;
         bool open_latch_;
         bool lock_n_go_;
         
@@ -304,18 +715,39 @@ class NukiLockComponent :
         uint32_t ble_general_timeout_ = 0;
         uint32_t ble_command_timeout_ = 0;
 
+        bool async_commands_ = false;
+        bool event_driven_ = false;
+        // Nuki events, set by notify() (possibly on the BLE worker) and handled in loop()
+        std::atomic<uint32_t> pending_events_{0};
+        // Incremented by unpair(), results of jobs queued before are dropped
+        uint32_t ble_generation_ = 0;
+
         uint32_t pairing_mode_timeout_ = 0;
         bool pairing_mode_ = false;
 
+        // Event log cursor, the next request continues after this index
         uint32_t last_rolling_log_id = 0;
+        uint32_t event_log_start_index_ = 0;
+        uint16_t event_log_count_ = MAX_EVENT_LOG_ENTRIES;
 
         ESPPreferenceObject pref_;
+        ESPPreferenceObject cache_pref_;
+        bool cache_dirty_ = false;
 
     private:
         NukiLock::NukiLock nuki_lock_;
 
         void lock_n_go();
         void print_keypad_entries();
+        void print_keypad_cache();
+        void request_keypad_data(bool full);
+        void keypad_batch(std::vector<std::string> operations, std::vector<int32_t> ids, std::vector<std::string> names,
+                          std::vector<int32_t> codes, std::vector<bool> enabled);
+        bool queue_keypad_operations(std::vector<KeypadOperation> &&operations);
+        void sync_keypad_codes(std::vector<std::string> names, std::vector<int32_t> codes, std::vector<bool> enabled);
+        void reconcile_keypad_codes();
+        static const char *keypad_operation_to_string(KeypadOperationType type);
+        void print_command_trace();
         void add_keypad_entry(std::string name, int32_t code);
         void update_keypad_entry(int32_t id, std::string name, int32_t code, bool enabled);
         void delete_keypad_entry(int32_t id);
@@ -323,8 +755,26 @@ class NukiLockComponent :
         bool valid_keypad_name(std::string name);
         bool valid_keypad_code(int32_t code);
 
-        std::vector<uint16_t> keypad_code_ids_;
         bool keypad_paired_;
+        KeypadCache keypad_cache_;
+        uint16_t keypad_data_offset_ = 0;
+        // Full refreshes drop codes the lock no longer reports, otherwise only new codes are fetched
+        bool keypad_data_full_ = false;
+        bool keypad_print_pending_ = false;
+
+        // Queued by keypad_batch, executed one per scheduler slot in a single session
+        std::deque<KeypadOperation> keypad_operations_;
+        std::vector<ConfigChange> config_changes_;
+        KeypadOperation executing_keypad_operation_;
+        uint16_t keypad_batch_succeeded_ = 0;
+        uint16_t keypad_batch_failed_ = 0;
+        bool keypad_batch_added_ = false;
+
+        // Declared keypad codes, reconciled against the keypad cache after a full refresh
+        std::vector<KeypadCode> keypad_codes_;
+        bool keypad_codes_exclusive_ = false;
+        bool keypad_sync_pending_ = false;
+        bool keypad_sync_followup_ = false;
 };
 
 // Entities
@@ -0,0 +1,40 @@
+#include <algorithm>
+
+#include "BleScanner.h"
+#include "nuki_fake.h"
+
+namespace BleScanner {
+
+Scanner::Scanner() {
+    nuki_fake::SmartLock::instance().add_scanner(this);
+}
+
+Scanner::~Scanner() {
+    nuki_fake::SmartLock::instance().remove_scanner(this);
+}
+
+void Scanner::initialize(const std::string &deviceName, const bool wantDuplicates, const uint16_t interval, const uint16_t window) {}
+
+void Scanner::update() {
+    this->updates_++;
+}
+
+void Scanner::setScanDuration(const uint32_t value) {}
+
+void Scanner::subscribe(Subscriber *subscriber) {
+    if (std::find(this->subscribers_.begin(), this->subscribers_.end(), subscriber) == this->subscribers_.end()) {
+        this->subscribers_.push_back(subscriber);
+    }
+}
+
+void Scanner::unsubscribe(Subscriber *subscriber) {
+    this->subscribers_.erase(std::remove(this->subscribers_.begin(), this->subscribers_.end(), subscriber), this->subscribers_.end());
+}
+
+void Scanner::deliver(const NimBLEAdvertisedDevice *device) {
+    for (Subscriber *subscriber : this->subscribers_) {
+        subscriber->onResult(device);
+    }
+}
+
+} //namespace BleScanner
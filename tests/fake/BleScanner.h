@@ -0,0 +1,72 @@
+#pragma once
+
+// Host stand-in for the BleScanner library. Advertisements are injected by the
+// simulated lock, see nuki_fake::SmartLock::advertise().
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class NimBLEAddress
+{
+    public:
+        NimBLEAddress() = default;
+        explicit NimBLEAddress(uint64_t address) : address_(address) {}
+
+        bool operator==(const NimBLEAddress &other) const { return this->address_ == other.address_; }
+        bool operator!=(const NimBLEAddress &other) const { return this->address_ != other.address_; }
+
+    protected:
+        uint64_t address_ = 0;
+};
+
+class NimBLEAdvertisedDevice
+{
+    public:
+        NimBLEAdvertisedDevice(const NimBLEAddress &address, int rssi, const std::string &manufacturer_data)
+            : address_(address), rssi_(rssi), manufacturer_data_(manufacturer_data) {}
+
+        NimBLEAddress getAddress() const { return this->address_; }
+        int getRSSI() const { return this->rssi_; }
+        std::string getManufacturerData(uint8_t index = 0) const { return this->manufacturer_data_; }
+        bool haveManufacturerData() const { return !this->manufacturer_data_.empty(); }
+
+    protected:
+        NimBLEAddress address_;
+        int rssi_;
+        std::string manufacturer_data_;
+};
+
+namespace BleScanner {
+
+class Subscriber
+{
+    public:
+        virtual ~Subscriber() {}
+        virtual void onResult(const NimBLEAdvertisedDevice *advertisedDevice) = 0;
+};
+
+class Scanner
+{
+    public:
+        Scanner();
+        ~Scanner();
+
+        void initialize(const std::string &deviceName = "blescanner", const bool wantDuplicates = false,
+                        const uint16_t interval = 23, const uint16_t window = 23);
+        void update();
+        void setScanDuration(const uint32_t value);
+        void subscribe(Subscriber *subscriber);
+        void unsubscribe(Subscriber *subscriber);
+
+        // Delivers an advertisement to all subscribers
+        void deliver(const NimBLEAdvertisedDevice *device);
+
+        uint32_t get_updates() const { return this->updates_; }
+
+    protected:
+        std::vector<Subscriber *> subscribers_;
+        uint32_t updates_ = 0;
+};
+
+} //namespace BleScanner
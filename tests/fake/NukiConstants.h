@@ -0,0 +1,86 @@
+#pragma once
+
+// Host stand-in for the NukiBleEsp32 constants, only what the component uses
+
+#include <cstdint>
+
+namespace Nuki {
+
+enum class CmdResult : uint8_t
+{
+    Success = 1,
+    Failed = 2,
+    TimeOut = 3,
+    Working = 4,
+    NotPaired = 5,
+    Lock_Busy = 6,
+    Error = 99
+};
+
+enum class EventType
+{
+    KeyTurnerStatusUpdated,
+    KeyTurnerStatusReset,
+    ERROR_BAD_PIN,
+    BLE_ERROR_ON_DISCONNECT
+};
+
+enum class DoorSensorState : uint8_t
+{
+    Unavailable = 0,
+    Deactivated = 1,
+    DoorClosed = 2,
+    DoorOpened = 3
+};
+
+enum class BatteryType : uint8_t
+{
+    Alkali = 0,
+    Accumulators = 1,
+    Lithium = 2
+};
+
+enum class AdvertisingMode : uint8_t
+{
+    Automatic = 0,
+    Normal = 1,
+    Slow = 2,
+    Slowest = 3
+};
+
+enum class TimeZoneId : uint16_t
+{
+    Africa_Cairo, Africa_Lagos, Africa_Maputo, Africa_Nairobi, America_Anchorage, America_Argentina_Buenos_Aires,
+    America_Chicago, America_Denver, America_Halifax, America_Los_Angeles, America_Manaus, America_Mexico_City,
+    America_New_York, America_Phoenix, America_Regina, America_Santiago, America_Sao_Paulo, America_St_Johns,
+    Asia_Bangkok, Asia_Dubai, Asia_Hong_Kong, Asia_Jerusalem, Asia_Karachi, Asia_Kathmandu, Asia_Kolkata,
+    Asia_Riyadh, Asia_Seoul, Asia_Shanghai, Asia_Tehran, Asia_Tokyo, Asia_Yangon, Australia_Adelaide,
+    Australia_Brisbane, Australia_Darwin, Australia_Hobart, Australia_Perth, Australia_Sydney, Europe_Berlin,
+    Europe_Helsinki, Europe_Istanbul, Europe_London, Europe_Moscow, Pacific_Auckland, Pacific_Guam,
+    Pacific_Honolulu, Pacific_Pago_Pago,
+    None = 65535
+};
+
+enum class AuthorizationIdType : uint8_t
+{
+    App = 0,
+    Bridge = 1,
+    Fob = 2,
+    Keypad = 3
+};
+
+enum class PairingResult
+{
+    Pairing,
+    Success,
+    Timeout
+};
+
+class SmartlockEventHandler
+{
+    public:
+        virtual ~SmartlockEventHandler() {}
+        virtual void notify(EventType eventType) = 0;
+};
+
+} //namespace Nuki
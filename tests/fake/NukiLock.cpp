@@ -0,0 +1,315 @@
+#include <cstring>
+
+#include "esphome/core/hal.h"
+
+#include "NukiLock.h"
+#include "nuki_fake.h"
+
+using nuki_fake::SmartLock;
+
+namespace NukiLock {
+
+static SmartLock &lock() {
+    return SmartLock::instance();
+}
+
+void cmdResultToString(const Nuki::CmdResult state, char *str) {
+    switch (state) {
+        case Nuki::CmdResult::Success: strcpy(str, "success"); break;
+        case Nuki::CmdResult::Failed: strcpy(str, "failed"); break;
+        case Nuki::CmdResult::TimeOut: strcpy(str, "timeOut"); break;
+        case Nuki::CmdResult::Working: strcpy(str, "working"); break;
+        case Nuki::CmdResult::NotPaired: strcpy(str, "notPaired"); break;
+        case Nuki::CmdResult::Lock_Busy: strcpy(str, "lockBusy"); break;
+        default: strcpy(str, "error"); break;
+    }
+}
+
+void lockstateToString(const LockState state, char *str) {
+    switch (state) {
+        case LockState::Uncalibrated: strcpy(str, "uncalibrated"); break;
+        case LockState::Locked: strcpy(str, "locked"); break;
+        case LockState::Unlocking: strcpy(str, "unlocking"); break;
+        case LockState::Unlocked: strcpy(str, "unlocked"); break;
+        case LockState::Locking: strcpy(str, "locking"); break;
+        case LockState::Unlatched: strcpy(str, "unlatched"); break;
+        case LockState::UnlockedLnga: strcpy(str, "unlockedLnga"); break;
+        case LockState::Unlatching: strcpy(str, "unlatching"); break;
+        case LockState::Calibration: strcpy(str, "calibration"); break;
+        case LockState::BootRun: strcpy(str, "bootRun"); break;
+        case LockState::MotorBlocked: strcpy(str, "motorBlocked"); break;
+        default: strcpy(str, "undefined"); break;
+    }
+}
+
+void lockactionToString(const LockAction action, char *str) {
+    switch (action) {
+        case LockAction::Unlock: strcpy(str, "Unlock"); break;
+        case LockAction::Lock: strcpy(str, "Lock"); break;
+        case LockAction::Unlatch: strcpy(str, "Unlatch"); break;
+        case LockAction::LockNgo: strcpy(str, "LockNgo"); break;
+        case LockAction::LockNgoUnlatch: strcpy(str, "LockNgoUnlatch"); break;
+        case LockAction::FullLock: strcpy(str, "FullLock"); break;
+        default: strcpy(str, "undefined"); break;
+    }
+}
+
+void triggerToString(const Trigger trigger, char *str) {
+    switch (trigger) {
+        case Trigger::System: strcpy(str, "system"); break;
+        case Trigger::Manual: strcpy(str, "manual"); break;
+        case Trigger::Button: strcpy(str, "button"); break;
+        case Trigger::Automatic: strcpy(str, "automatic"); break;
+        case Trigger::AutoLock: strcpy(str, "autoLock"); break;
+        default: strcpy(str, "undefined"); break;
+    }
+}
+
+void doorSensorStateToString(const Nuki::DoorSensorState state, char *str) {
+    switch (state) {
+        case Nuki::DoorSensorState::Unavailable: strcpy(str, "unavailable"); break;
+        case Nuki::DoorSensorState::Deactivated: strcpy(str, "deactivated"); break;
+        case Nuki::DoorSensorState::DoorClosed: strcpy(str, "doorClosed"); break;
+        case Nuki::DoorSensorState::DoorOpened: strcpy(str, "doorOpened"); break;
+        default: strcpy(str, "undefined"); break;
+    }
+}
+
+void loggingTypeToString(const LoggingType type, char *str) {
+    switch (type) {
+        case LoggingType::LoggingEnabled: strcpy(str, "LoggingEnabled"); break;
+        case LoggingType::LockAction: strcpy(str, "LockAction"); break;
+        case LoggingType::Calibration: strcpy(str, "Calibration"); break;
+        case LoggingType::InitializationRun: strcpy(str, "InitializationRun"); break;
+        case LoggingType::KeypadAction: strcpy(str, "KeypadAction"); break;
+        case LoggingType::DoorSensor: strcpy(str, "DoorSensor"); break;
+        case LoggingType::DoorSensorLoggingEnabled: strcpy(str, "DoorSensorLoggingEnabled"); break;
+        default: strcpy(str, "undefined"); break;
+    }
+}
+
+void completionStatusToString(const CompletionStatus status, char *str) {
+    strcpy(str, status == CompletionStatus::Success ? "success" : "undefined");
+}
+
+NukiLock::NukiLock(const std::string &deviceName, const uint32_t deviceId) {}
+
+NukiLock::~NukiLock() {}
+
+void NukiLock::setEventHandler(Nuki::SmartlockEventHandler *handler) {
+    this->event_handler_ = handler;
+}
+
+void NukiLock::initialize() {}
+
+void NukiLock::registerBleScanner(BleScanner::Scanner *scanner) {
+    scanner->subscribe(this);
+}
+
+void NukiLock::onResult(const NimBLEAdvertisedDevice *advertisedDevice) {
+    if (advertisedDevice->getAddress() != this->getBleAddress()) {
+        return;
+    }
+
+    this->last_beacon_ = esphome::millis();
+    this->rssi_ = advertisedDevice->getRSSI();
+
+    // Like the library, every beacon with the state-change flag is notified
+    const std::string data = advertisedDevice->getManufacturerData();
+    if (this->event_handler_ != nullptr && data.size() >= 25 && (data[24] & 0x01) != 0) {
+        this->event_handler_->notify(Nuki::EventType::KeyTurnerStatusUpdated);
+    }
+}
+
+Nuki::CmdResult NukiLock::requestKeyTurnerState(KeyTurnerState *state) {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::status_requests);
+    if (result == Nuki::CmdResult::Success) {
+        lock().fill_state(state);
+    }
+    return result;
+}
+
+Nuki::CmdResult NukiLock::requestConfig(Config *config) {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::config_requests);
+    if (result == Nuki::CmdResult::Success) {
+        *config = lock().get_config();
+    }
+    return result;
+}
+
+Nuki::CmdResult NukiLock::requestAdvancedConfig(AdvancedConfig *config) {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::config_requests);
+    if (result == Nuki::CmdResult::Success) {
+        *config = lock().get_advanced_config();
+    }
+    return result;
+}
+
+Nuki::CmdResult NukiLock::lockAction(const LockAction action, const uint32_t nukiAppId, const uint8_t flags,
+                                     const char *nameSuffix, const uint8_t nameSuffixLen) {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::lock_actions);
+    if (result == Nuki::CmdResult::Success) {
+        lock().lock_action(action);
+    }
+    return result;
+}
+
+Nuki::CmdResult NukiLock::requestCalibration() {
+    return lock().begin_command(&SmartLock::Stats::lock_actions);
+}
+
+Nuki::CmdResult NukiLock::verifySecurityPin() {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::status_requests);
+    if (result == Nuki::CmdResult::Success && lock().pin != this->getUltraPincode()) {
+        return Nuki::CmdResult::Failed;
+    }
+    return result;
+}
+
+Nuki::CmdResult NukiLock::retrieveLogEntries(const uint32_t startIndex, const uint16_t count, const uint8_t sortOrder,
+                                             const bool totalCount) {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::list_requests);
+    if (result == Nuki::CmdResult::Success) {
+        lock().request_log(startIndex, count, sortOrder == 1);
+    }
+    return result;
+}
+
+void NukiLock::getLogEntries(std::list<LogEntry> *list) {
+    lock().received_log(list);
+}
+
+Nuki::CmdResult NukiLock::retrieveAuthorizationEntries(const uint16_t offset, const uint16_t count) {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::list_requests);
+    if (result == Nuki::CmdResult::Success) {
+        lock().request_auth(offset, count);
+    }
+    return result;
+}
+
+void NukiLock::getAuthorizationEntries(std::list<AuthorizationEntry> *list) {
+    lock().received_auth(list);
+}
+
+Nuki::CmdResult NukiLock::retrieveKeypadEntries(const uint16_t offset, const uint16_t count) {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::list_requests);
+    if (result == Nuki::CmdResult::Success) {
+        lock().request_keypad(offset, count);
+    }
+    return result;
+}
+
+void NukiLock::getKeypadEntries(std::list<KeypadEntry> *list) {
+    lock().received_keypad(list);
+}
+
+Nuki::CmdResult NukiLock::addKeypadEntry(NewKeypadEntry newKeypadEntry) {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::keypad_writes);
+    return result == Nuki::CmdResult::Success ? lock().keypad_add(newKeypadEntry) : result;
+}
+
+Nuki::CmdResult NukiLock::updateKeypadEntry(UpdatedKeypadEntry updatedKeypadEntry) {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::keypad_writes);
+    return result == Nuki::CmdResult::Success ? lock().keypad_update(updatedKeypadEntry) : result;
+}
+
+Nuki::CmdResult NukiLock::deleteKeypadEntry(uint16_t id) {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::keypad_writes);
+    return result == Nuki::CmdResult::Success ? lock().keypad_delete(id) : result;
+}
+
+Nuki::CmdResult NukiLock::setFromConfig(const Config config) {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::config_writes);
+    if (result == Nuki::CmdResult::Success) {
+        lock().write_config(&config, nullptr);
+    }
+    return result;
+}
+
+Nuki::CmdResult NukiLock::setFromAdvancedConfig(const AdvancedConfig config) {
+    Nuki::CmdResult result = lock().begin_command(&SmartLock::Stats::config_writes);
+    if (result == Nuki::CmdResult::Success) {
+        lock().write_config(nullptr, &config);
+    }
+    return result;
+}
+
+bool NukiLock::isLockUltra() {
+    return lock().ultra;
+}
+
+bool NukiLock::isPairedWithLock() {
+    return lock().paired;
+}
+
+bool NukiLock::isBatteryCritical() {
+    return lock().battery_percent < 10;
+}
+
+bool NukiLock::isBatteryCharging() {
+    return false;
+}
+
+uint8_t NukiLock::getBatteryPerc() {
+    return lock().battery_percent;
+}
+
+int NukiLock::getRssi() {
+    return this->rssi_;
+}
+
+unsigned long NukiLock::getLastReceivedBeaconTs() {
+    return this->last_beacon_;
+}
+
+const NimBLEAddress NukiLock::getBleAddress() const {
+    return NimBLEAddress(nuki_fake::LOCK_ADDRESS);
+}
+
+Nuki::PairingResult NukiLock::pairNuki(Nuki::AuthorizationIdType idType) {
+    // Pairing is a connection of its own, counted like a status request
+    lock().paired = true;
+    if (lock().begin_command(&SmartLock::Stats::status_requests) != Nuki::CmdResult::Success) {
+        lock().paired = false;
+        return Nuki::PairingResult::Timeout;
+    }
+    return Nuki::PairingResult::Success;
+}
+
+bool NukiLock::unPairNuki() {
+    lock().disconnect();
+    lock().paired = false;
+    return true;
+}
+
+bool NukiLock::saveSecurityPincode(const uint16_t pinCode) {
+    this->pin_ = pinCode;
+    return true;
+}
+
+bool NukiLock::saveUltraPincode(const uint32_t pinCode, bool save) {
+    this->pin_ = pinCode;
+    return true;
+}
+
+uint16_t NukiLock::getSecurityPincode() {
+    return static_cast<uint16_t>(this->pin_);
+}
+
+uint32_t NukiLock::getUltraPincode() {
+    return this->pin_;
+}
+
+void NukiLock::updateConnectionState() {
+    lock().update_connection();
+}
+
+void NukiLock::disconnect() {
+    lock().disconnect();
+}
+
+void NukiLock::setDisconnectTimeout(const uint32_t timeout) {
+    lock().set_disconnect_timeout(timeout);
+}
+
+} //namespace NukiLock
@@ -0,0 +1,291 @@
+#pragma once
+
+// Host stand-in for NukiBleEsp32's NukiLock. Every call is forwarded to the
+// simulated lock in nuki_fake.h, which adds latency, failures and counters.
+
+#include <cstdint>
+#include <list>
+#include <string>
+
+#include "NukiConstants.h"
+#include "BleScanner.h"
+
+namespace NukiLock {
+
+enum class LockState : uint8_t
+{
+    Uncalibrated = 0,
+    Locked = 1,
+    Unlocking = 2,
+    Unlocked = 3,
+    Locking = 4,
+    Unlatched = 5,
+    UnlockedLnga = 6,
+    Unlatching = 7,
+    Calibration = 0xFC,
+    BootRun = 0xFD,
+    MotorBlocked = 0xFE,
+    Undefined = 0xFF
+};
+
+enum class LockAction : uint8_t
+{
+    Unlock = 1,
+    Lock = 2,
+    Unlatch = 3,
+    LockNgo = 4,
+    LockNgoUnlatch = 5,
+    FullLock = 6
+};
+
+enum class ButtonPressAction : uint8_t
+{
+    NoAction,
+    Intelligent,
+    Unlock,
+    Lock,
+    Unlatch,
+    LockNgo,
+    ShowStatus
+};
+
+enum class MotorSpeed : uint8_t
+{
+    Standard,
+    Insane,
+    Gentle
+};
+
+enum class LoggingType : uint8_t
+{
+    LoggingEnabled = 1,
+    LockAction = 2,
+    Calibration = 3,
+    InitializationRun = 4,
+    KeypadAction = 5,
+    DoorSensor = 6,
+    DoorSensorLoggingEnabled = 7
+};
+
+enum class Trigger : uint8_t
+{
+    System,
+    Manual,
+    Button,
+    Automatic,
+    AutoLock = 6
+};
+
+enum class CompletionStatus : uint8_t
+{
+    Success
+};
+
+struct KeyTurnerState
+{
+    uint8_t nukiState;
+    LockState lockState;
+    Trigger trigger;
+    uint16_t currentTimeYear;
+    uint8_t currentTimeMonth;
+    uint8_t currentTimeDay;
+    uint8_t currentTimeHour;
+    uint8_t currentTimeMinute;
+    uint8_t currentTimeSecond;
+    int16_t timeZoneOffset;
+    uint8_t criticalBatteryState;
+    uint8_t configUpdateCount;
+    uint8_t lockNgoTimer;
+    LockAction lastLockAction;
+    Trigger lastLockActionTrigger;
+    CompletionStatus lastLockActionCompletionStatus;
+    Nuki::DoorSensorState doorSensorState;
+    uint16_t nightModeActive;
+    uint8_t accessoryBatteryState;
+};
+
+struct Config
+{
+    uint32_t nukiId;
+    uint8_t name[32];
+    float latitude;
+    float longitude;
+    uint8_t autoUnlatch;
+    uint8_t pairingEnabled;
+    uint8_t buttonEnabled;
+    uint8_t ledEnabled;
+    uint8_t ledBrightness;
+    int16_t timeZoneOffset;
+    uint8_t dstMode;
+    uint8_t hasFob;
+    uint8_t fobAction1;
+    uint8_t fobAction2;
+    uint8_t fobAction3;
+    uint8_t singleLock;
+    Nuki::AdvertisingMode advertisingMode;
+    uint8_t hasKeypad;
+    uint8_t firmwareVersion[3];
+    uint8_t hardwareRevision[2];
+    uint8_t homeKitStatus;
+    Nuki::TimeZoneId timeZoneId;
+    uint8_t deviceType;
+    uint8_t hasKeypadV2;
+    uint8_t matterStatus;
+    uint8_t productVariant;
+    uint8_t capabilities;
+};
+
+struct AdvancedConfig
+{
+    uint16_t totalDegrees;
+    int16_t unlockedPositionOffsetDegrees;
+    int16_t lockedPositionOffsetDegrees;
+    int16_t singleLockedPositionOffsetDegrees;
+    int16_t unlockedToLockedTransitionOffsetDegrees;
+    uint8_t lockNgoTimeout;
+    ButtonPressAction singleButtonPressAction;
+    ButtonPressAction doubleButtonPressAction;
+    uint8_t detachedCylinder;
+    Nuki::BatteryType batteryType;
+    uint8_t automaticBatteryTypeDetection;
+    uint8_t unlatchDuration;
+    uint16_t autoLockTimeOut;
+    uint8_t autoUnLockDisabled;
+    uint8_t nightModeEnabled;
+    uint8_t nightModeAutoLockEnabled;
+    uint8_t nightModeAutoUnlockDisabled;
+    uint8_t nightModeImmediateLockOnStart;
+    uint8_t autoLockEnabled;
+    uint8_t immediateAutoLockEnabled;
+    uint8_t autoUpdateEnabled;
+    MotorSpeed motorSpeed;
+    uint8_t enableSlowSpeedDuringNightMode;
+};
+
+struct LogEntry
+{
+    uint32_t index;
+    uint16_t timeStampYear;
+    uint8_t timeStampMonth;
+    uint8_t timeStampDay;
+    uint8_t timeStampHour;
+    uint8_t timeStampMinute;
+    uint8_t timeStampSecond;
+    uint32_t authId;
+    uint8_t name[32];
+    LoggingType loggingType;
+    uint8_t data[5];
+};
+
+struct AuthorizationEntry
+{
+    uint32_t authId;
+    uint8_t idType;
+    uint8_t name[32];
+    uint8_t enabled;
+    uint8_t remoteAllowed;
+};
+
+struct KeypadEntry
+{
+    uint16_t codeId;
+    uint32_t code;
+    uint8_t name[20];
+    uint8_t enabled;
+};
+
+struct NewKeypadEntry
+{
+    uint8_t name[20];
+    uint32_t code;
+    uint8_t timeLimited;
+};
+
+struct UpdatedKeypadEntry
+{
+    uint16_t codeId;
+    uint8_t name[20];
+    uint32_t code;
+    uint8_t enabled;
+    uint8_t timeLimited;
+};
+
+void cmdResultToString(const Nuki::CmdResult state, char *str);
+void lockstateToString(const LockState state, char *str);
+void lockactionToString(const LockAction action, char *str);
+void triggerToString(const Trigger trigger, char *str);
+void doorSensorStateToString(const Nuki::DoorSensorState state, char *str);
+void loggingTypeToString(const LoggingType type, char *str);
+void completionStatusToString(const CompletionStatus status, char *str);
+
+class NukiLock : public BleScanner::Subscriber
+{
+    public:
+        NukiLock(const std::string &deviceName, const uint32_t deviceId);
+        ~NukiLock();
+
+        void setEventHandler(Nuki::SmartlockEventHandler *handler);
+        void initialize();
+        void registerBleScanner(BleScanner::Scanner *scanner);
+        void onResult(const NimBLEAdvertisedDevice *advertisedDevice) override;
+
+        Nuki::CmdResult requestKeyTurnerState(KeyTurnerState *state);
+        Nuki::CmdResult requestConfig(Config *config);
+        Nuki::CmdResult requestAdvancedConfig(AdvancedConfig *config);
+        Nuki::CmdResult lockAction(const LockAction action, const uint32_t nukiAppId = 0, const uint8_t flags = 0,
+                                   const char *nameSuffix = nullptr, const uint8_t nameSuffixLen = 0);
+        Nuki::CmdResult requestCalibration();
+        Nuki::CmdResult verifySecurityPin();
+
+        Nuki::CmdResult retrieveLogEntries(const uint32_t startIndex, const uint16_t count, const uint8_t sortOrder,
+                                           const bool totalCount);
+        void getLogEntries(std::list<LogEntry> *list);
+        Nuki::CmdResult retrieveAuthorizationEntries(const uint16_t offset, const uint16_t count);
+        void getAuthorizationEntries(std::list<AuthorizationEntry> *list);
+        Nuki::CmdResult retrieveKeypadEntries(const uint16_t offset, const uint16_t count);
+        void getKeypadEntries(std::list<KeypadEntry> *list);
+        Nuki::CmdResult addKeypadEntry(NewKeypadEntry newKeypadEntry);
+        Nuki::CmdResult updateKeypadEntry(UpdatedKeypadEntry updatedKeypadEntry);
+        Nuki::CmdResult deleteKeypadEntry(uint16_t id);
+
+        Nuki::CmdResult setFromConfig(const Config config);
+        Nuki::CmdResult setFromAdvancedConfig(const AdvancedConfig config);
+
+        bool isLockUltra();
+        bool isPairedWithLock();
+        bool isBatteryCritical();
+        bool isBatteryCharging();
+        uint8_t getBatteryPerc();
+        int getRssi();
+        unsigned long getLastReceivedBeaconTs();
+        const NimBLEAddress getBleAddress() const;
+
+        Nuki::PairingResult pairNuki(Nuki::AuthorizationIdType idType);
+        bool unPairNuki();
+        bool saveSecurityPincode(const uint16_t pinCode);
+        bool saveUltraPincode(const uint32_t pinCode, bool save = true);
+        uint16_t getSecurityPincode();
+        uint32_t getUltraPincode();
+
+        void updateConnectionState();
+        void disconnect();
+        void setConnectTimeout(const uint8_t timeout) {}
+        void setConnectRetries(const uint8_t retries) {}
+        void setDisconnectTimeout(const uint32_t timeout);
+        void setGeneralTimeout(const long timeout) {}
+        void setCommandTimeout(const long timeout) {}
+        void setDebugConnect(bool enable) {}
+        void setDebugCommunication(bool enable) {}
+        void setDebugReadableData(bool enable) {}
+        void setDebugHexData(bool enable) {}
+        void setDebugCommand(bool enable) {}
+
+    protected:
+        Nuki::SmartlockEventHandler *event_handler_ = nullptr;
+        unsigned long last_beacon_ = 0;
+        int rssi_ = 0;
+        // Kept in NVS by the real library
+        uint32_t pin_ = 0;
+};
+
+} //namespace NukiLock
@@ -0,0 +1,544 @@
+#include <algorithm>
+#include <cstring>
+
+#include "esphome/core/hal.h"
+
+#include "nuki_fake.h"
+
+using esphome::delay;
+using esphome::millis;
+
+namespace nuki_fake {
+
+// Name the lock logs actions of the component with
+static const char *COMPONENT_NAME = "Nuki ESPHome";
+static const uint32_t COMPONENT_AUTH_ID = 1;
+
+// Length of the manufacturer data of a Nuki beacon, the state-change flag is in byte 24
+static const size_t BEACON_LENGTH = 25;
+
+static bool is_due(uint32_t now, uint32_t time) {
+    return static_cast<int32_t>(now - time) >= 0;
+}
+
+template<size_t N> static void copy_name(uint8_t (&dest)[N], const char *name) {
+    memset(dest, 0, N);
+    strncpy(reinterpret_cast<char *>(dest), name, N - 1);
+}
+
+SmartLock &SmartLock::instance() {
+    static SmartLock lock;
+    return lock;
+}
+
+void SmartLock::reset() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+
+    this->connect_millis = 600;
+    this->command_millis = 150;
+    this->entry_millis = 40;
+    this->transition_millis = 1500;
+    this->advertising_millis = 500;
+    this->ultra = false;
+    this->paired = true;
+    this->battery_percent = 80;
+    this->rssi = -60;
+    this->pin = 0;
+
+    this->state_ = NukiLock::LockState::Locked;
+    this->target_state_ = NukiLock::LockState::Locked;
+    this->transition_end_ = 0;
+    this->last_action_ = NukiLock::LockAction::Lock;
+    this->last_trigger_ = NukiLock::Trigger::Manual;
+    this->state_changed_ = false;
+    this->next_advertisement_ = millis();
+
+    memset(&this->config_, 0, sizeof(this->config_));
+    this->config_.nukiId = 0x1234abcd;
+    copy_name(this->config_.name, "Front Door");
+    this->config_.buttonEnabled = 1;
+    this->config_.ledEnabled = 1;
+    this->config_.ledBrightness = 3;
+    this->config_.timeZoneId = Nuki::TimeZoneId::Europe_Berlin;
+    this->config_.advertisingMode = Nuki::AdvertisingMode::Automatic;
+
+    memset(&this->advanced_config_, 0, sizeof(this->advanced_config_));
+    this->advanced_config_.totalDegrees = 720;
+    this->advanced_config_.lockNgoTimeout = 20;
+    this->advanced_config_.singleButtonPressAction = NukiLock::ButtonPressAction::Intelligent;
+    this->advanced_config_.doubleButtonPressAction = NukiLock::ButtonPressAction::LockNgo;
+    this->advanced_config_.batteryType = Nuki::BatteryType::Alkali;
+    this->advanced_config_.unlatchDuration = 3;
+    this->advanced_config_.autoLockTimeOut = 60;
+    this->advanced_config_.motorSpeed = NukiLock::MotorSpeed::Standard;
+
+    this->config_update_count_ = 1;
+
+    this->log_.clear();
+    this->auth_.clear();
+    this->keypad_.clear();
+    this->next_keypad_id_ = 1;
+    this->log_result_.clear();
+    this->auth_result_.clear();
+    this->keypad_result_.clear();
+
+    this->add_auth_entry(COMPONENT_AUTH_ID, COMPONENT_NAME);
+
+    this->connected_ = false;
+    this->last_activity_ = 0;
+    this->disconnect_timeout_ = 2000;
+
+    this->fail_next_ = 0;
+    this->fail_every_ = 0;
+    this->script_.clear();
+
+    this->stats_ = Stats();
+}
+
+void SmartLock::reset_stats() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->stats_ = Stats();
+}
+
+void SmartLock::fail_next(uint32_t count, Nuki::CmdResult result) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->fail_next_ = count;
+    this->fail_next_result_ = result;
+}
+
+void SmartLock::fail_every(uint32_t nth, Nuki::CmdResult result) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->fail_every_ = nth;
+    this->fail_every_result_ = result;
+}
+
+void SmartLock::script(const std::deque<Outcome> &outcomes) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->script_ = outcomes;
+}
+
+void SmartLock::turn(NukiLock::LockState state, NukiLock::Trigger trigger) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    const NukiLock::LockAction action = state == NukiLock::LockState::Locked ? NukiLock::LockAction::Lock : NukiLock::LockAction::Unlock;
+    this->transition_end_ = 0;
+    this->change_state_(state, action, trigger);
+}
+
+void SmartLock::change_config(const NukiLock::Config &config) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->config_ = config;
+    this->config_update_count_++;
+    this->state_changed_ = true;
+}
+
+void SmartLock::change_advanced_config(const NukiLock::AdvancedConfig &config) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->advanced_config_ = config;
+    this->config_update_count_++;
+    this->state_changed_ = true;
+}
+
+void SmartLock::add_log_entry(NukiLock::LoggingType type, uint32_t auth_id, const char *name, NukiLock::LockAction action) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+
+    NukiLock::LogEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.index = this->log_.empty() ? 1 : this->log_.back().index + 1;
+
+    // One entry per second of virtual time, starting at a fixed date
+    const uint32_t seconds = millis() / 1000;
+    entry.timeStampYear = 2025;
+    entry.timeStampMonth = 6;
+    entry.timeStampDay = 1 + (seconds / 86400) % 28;
+    entry.timeStampHour = (seconds / 3600) % 24;
+    entry.timeStampMinute = (seconds / 60) % 60;
+    entry.timeStampSecond = seconds % 60;
+
+    entry.authId = auth_id;
+    copy_name(entry.name, name);
+    entry.loggingType = type;
+    entry.data[0] = static_cast<uint8_t>(action);
+    entry.data[1] = static_cast<uint8_t>(this->last_trigger_);
+    this->log_.push_back(entry);
+}
+
+void SmartLock::add_auth_entry(uint32_t auth_id, const char *name) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+
+    NukiLock::AuthorizationEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.authId = auth_id;
+    entry.idType = 0;
+    copy_name(entry.name, name);
+    entry.enabled = 1;
+    entry.remoteAllowed = 1;
+    this->auth_[auth_id] = entry;
+}
+
+void SmartLock::add_keypad_entry(uint16_t code_id, const char *name, uint32_t code, bool enabled) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+
+    NukiLock::KeypadEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.codeId = code_id;
+    entry.code = code;
+    copy_name(entry.name, name);
+    entry.enabled = enabled;
+    this->keypad_[code_id] = entry;
+    this->next_keypad_id_ = std::max<uint16_t>(this->next_keypad_id_, code_id + 1);
+}
+
+void SmartLock::tick() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->advance_transition_();
+
+    const uint32_t now = millis();
+    if (this->advertising_millis != 0 && is_due(now, this->next_advertisement_)) {
+        this->next_advertisement_ = now + this->advertising_millis;
+        this->advertise();
+    }
+}
+
+void SmartLock::advertise() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+
+    std::string data(BEACON_LENGTH, '\0');
+    data[0] = 0x4c;
+    data[BEACON_LENGTH - 1] = this->state_changed_ ? 0x01 : 0x00;
+
+    const NimBLEAdvertisedDevice device(NimBLEAddress(LOCK_ADDRESS), this->rssi, data);
+    this->stats_.beacons++;
+    for (BleScanner::Scanner *scanner : this->scanners_) {
+        scanner->deliver(&device);
+    }
+}
+
+NukiLock::LockState SmartLock::get_state() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->advance_transition_();
+    return this->state_;
+}
+
+NukiLock::Config SmartLock::get_config() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    return this->config_;
+}
+
+NukiLock::AdvancedConfig SmartLock::get_advanced_config() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    return this->advanced_config_;
+}
+
+uint8_t SmartLock::get_config_update_count() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    return this->config_update_count_;
+}
+
+size_t SmartLock::get_log_size() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    return this->log_.size();
+}
+
+size_t SmartLock::get_keypad_size() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    return this->keypad_.size();
+}
+
+bool SmartLock::is_connected() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    return this->connected_;
+}
+
+SmartLock::Stats SmartLock::get_stats() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    return this->stats_;
+}
+
+/**
+ * @brief Connects if needed, decides the result and spends the time of the transaction.
+ *
+ * A failed transaction drops the connection, like a lost link would.
+ */
+Nuki::CmdResult SmartLock::begin_command(uint32_t Stats::*counter) {
+    std::unique_lock<std::recursive_mutex> guard(this->mutex_);
+
+    if (!this->paired) {
+        return Nuki::CmdResult::NotPaired;
+    }
+
+    const uint32_t now = millis();
+    uint32_t duration = this->command_millis;
+
+    if (this->connected_) {
+        this->stats_.max_idle_connected_millis = std::max(this->stats_.max_idle_connected_millis, now - this->last_activity_);
+    } else {
+        this->connected_ = true;
+        this->stats_.connects++;
+        duration += this->connect_millis;
+    }
+
+    this->stats_.commands++;
+    this->stats_.*counter += 1;
+
+    Nuki::CmdResult result = Nuki::CmdResult::Success;
+    if (!this->script_.empty()) {
+        result = this->script_.front().result;
+        duration = this->script_.front().duration_millis;
+        this->script_.pop_front();
+    } else if (this->fail_next_ > 0) {
+        this->fail_next_--;
+        result = this->fail_next_result_;
+    } else if (this->fail_every_ != 0 && this->stats_.commands % this->fail_every_ == 0) {
+        result = this->fail_every_result_;
+    }
+
+    if (result != Nuki::CmdResult::Success) {
+        this->stats_.failures++;
+        this->connected_ = false;
+        this->stats_.disconnects++;
+    }
+
+    guard.unlock();
+    delay(duration);
+    guard.lock();
+
+    this->last_activity_ = millis();
+    return result;
+}
+
+void SmartLock::fill_state(NukiLock::KeyTurnerState *state) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->advance_transition_();
+
+    memset(state, 0, sizeof(*state));
+    state->nukiState = 2;
+    state->lockState = this->state_;
+    state->trigger = this->last_trigger_;
+    state->currentTimeYear = 2025;
+    state->currentTimeMonth = 6;
+    state->currentTimeDay = 1;
+    state->criticalBatteryState = (this->battery_percent / 2) << 2;
+    state->configUpdateCount = this->config_update_count_;
+    state->lastLockAction = this->last_action_;
+    state->lastLockActionTrigger = this->last_trigger_;
+    state->lastLockActionCompletionStatus = NukiLock::CompletionStatus::Success;
+    state->doorSensorState = Nuki::DoorSensorState::DoorClosed;
+
+    // Reading the state clears the flag in the beacon
+    this->state_changed_ = false;
+}
+
+void SmartLock::lock_action(NukiLock::LockAction action) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->advance_transition_();
+
+    NukiLock::LockState transition;
+    NukiLock::LockState target;
+    switch (action) {
+        case NukiLock::LockAction::Lock:
+        case NukiLock::LockAction::FullLock:
+            transition = NukiLock::LockState::Locking;
+            target = NukiLock::LockState::Locked;
+            break;
+        case NukiLock::LockAction::Unlatch:
+        case NukiLock::LockAction::LockNgoUnlatch:
+            transition = NukiLock::LockState::Unlatching;
+            target = NukiLock::LockState::Unlatched;
+            break;
+        default:
+            transition = NukiLock::LockState::Unlocking;
+            target = NukiLock::LockState::Unlocked;
+            break;
+    }
+
+    this->last_action_ = action;
+    this->last_trigger_ = NukiLock::Trigger::System;
+    this->target_state_ = target;
+
+    if (this->state_ == target || this->transition_millis == 0) {
+        this->transition_end_ = 0;
+        this->change_state_(target, action, NukiLock::Trigger::System);
+        return;
+    }
+
+    this->state_ = transition;
+    this->state_changed_ = true;
+    this->transition_end_ = millis() + this->transition_millis;
+}
+
+void SmartLock::write_config(const NukiLock::Config *config, const NukiLock::AdvancedConfig *advanced_config) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    if (config != nullptr) {
+        this->config_ = *config;
+    }
+    if (advanced_config != nullptr) {
+        this->advanced_config_ = *advanced_config;
+    }
+    this->config_update_count_++;
+}
+
+void SmartLock::request_log(uint32_t start_index, uint16_t count, bool newest_first) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+
+    this->log_result_.clear();
+    uint32_t arrival = millis();
+
+    if (newest_first) {
+        for (auto it = this->log_.rbegin(); it != this->log_.rend() && this->log_result_.size() < count; ++it) {
+            arrival += this->entry_millis;
+            this->log_result_.push_back({arrival, *it});
+        }
+        return;
+    }
+
+    for (const NukiLock::LogEntry &entry : this->log_) {
+        if (this->log_result_.size() >= count) {
+            break;
+        }
+        if (entry.index >= start_index) {
+            arrival += this->entry_millis;
+            this->log_result_.push_back({arrival, entry});
+        }
+    }
+}
+
+void SmartLock::request_auth(uint16_t offset, uint16_t count) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+
+    this->auth_result_.clear();
+    uint32_t arrival = millis();
+    uint16_t position = 0;
+
+    for (const auto &it : this->auth_) {
+        if (position++ < offset) {
+            continue;
+        }
+        if (this->auth_result_.size() >= count) {
+            break;
+        }
+        arrival += this->entry_millis;
+        this->auth_result_.push_back({arrival, it.second});
+    }
+}
+
+void SmartLock::request_keypad(uint16_t offset, uint16_t count) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+
+    this->keypad_result_.clear();
+    uint32_t arrival = millis();
+    uint16_t position = 0;
+
+    for (const auto &it : this->keypad_) {
+        if (position++ < offset) {
+            continue;
+        }
+        if (this->keypad_result_.size() >= count) {
+            break;
+        }
+        arrival += this->entry_millis;
+        this->keypad_result_.push_back({arrival, it.second});
+    }
+}
+
+template<typename T> static void copy_arrived(const std::vector<Pending<T>> &pending, std::list<T> *list) {
+    const uint32_t now = millis();
+    list->clear();
+    for (const Pending<T> &item : pending) {
+        if (is_due(now, item.arrival)) {
+            list->push_back(item.entry);
+        }
+    }
+}
+
+void SmartLock::received_log(std::list<NukiLock::LogEntry> *list) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    copy_arrived(this->log_result_, list);
+}
+
+void SmartLock::received_auth(std::list<NukiLock::AuthorizationEntry> *list) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    copy_arrived(this->auth_result_, list);
+}
+
+void SmartLock::received_keypad(std::list<NukiLock::KeypadEntry> *list) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    copy_arrived(this->keypad_result_, list);
+}
+
+Nuki::CmdResult SmartLock::keypad_add(const NukiLock::NewKeypadEntry &entry) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+
+    for (const auto &it : this->keypad_) {
+        if (strncmp(reinterpret_cast<const char *>(it.second.name), reinterpret_cast<const char *>(entry.name), sizeof(entry.name)) == 0) {
+            return Nuki::CmdResult::Failed;
+        }
+    }
+
+    this->add_keypad_entry(this->next_keypad_id_, reinterpret_cast<const char *>(entry.name), entry.code);
+    return Nuki::CmdResult::Success;
+}
+
+Nuki::CmdResult SmartLock::keypad_update(const NukiLock::UpdatedKeypadEntry &entry) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+
+    auto it = this->keypad_.find(entry.codeId);
+    if (it == this->keypad_.end()) {
+        return Nuki::CmdResult::Failed;
+    }
+    memcpy(it->second.name, entry.name, sizeof(entry.name));
+    it->second.code = entry.code;
+    it->second.enabled = entry.enabled;
+    return Nuki::CmdResult::Success;
+}
+
+Nuki::CmdResult SmartLock::keypad_delete(uint16_t code_id) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    return this->keypad_.erase(code_id) > 0 ? Nuki::CmdResult::Success : Nuki::CmdResult::Failed;
+}
+
+void SmartLock::update_connection() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->stats_.connection_checks++;
+    if (this->connected_ && millis() - this->last_activity_ > this->disconnect_timeout_) {
+        this->connected_ = false;
+        this->stats_.disconnects++;
+    }
+}
+
+void SmartLock::disconnect() {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    if (this->connected_) {
+        this->connected_ = false;
+        this->stats_.disconnects++;
+    }
+}
+
+void SmartLock::add_scanner(BleScanner::Scanner *scanner) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->scanners_.push_back(scanner);
+}
+
+void SmartLock::remove_scanner(BleScanner::Scanner *scanner) {
+    std::lock_guard<std::recursive_mutex> guard(this->mutex_);
+    this->scanners_.erase(std::remove(this->scanners_.begin(), this->scanners_.end(), scanner), this->scanners_.end());
+}
+
+void SmartLock::advance_transition_() {
+    if (this->transition_end_ != 0 && is_due(millis(), this->transition_end_)) {
+        this->transition_end_ = 0;
+        this->change_state_(this->target_state_, this->last_action_, this->last_trigger_);
+    }
+}
+
+void SmartLock::change_state_(NukiLock::LockState state, NukiLock::LockAction action, NukiLock::Trigger trigger) {
+    this->state_ = state;
+    this->last_action_ = action;
+    this->last_trigger_ = trigger;
+    this->state_changed_ = true;
+
+    const bool by_component = trigger == NukiLock::Trigger::System;
+    this->add_log_entry(NukiLock::LoggingType::LockAction, by_component ? COMPONENT_AUTH_ID : 0,
+                        by_component ? COMPONENT_NAME : "Manual", action);
+}
+
+} //namespace nuki_fake
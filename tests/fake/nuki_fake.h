@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "NukiLock.h"
+
+namespace nuki_fake {
+
+// Address the simulated lock advertises with
+static const uint64_t LOCK_ADDRESS = 0x54d272000001ULL;
+
+// Entry of a list request and the time it reaches the library
+template<typename T> struct Pending
+{
+    uint32_t arrival;
+    T entry;
+};
+
+/**
+ * @brief Simulated smart lock behind the fake NukiLock library.
+ *
+ * Models what costs time or energy on a real lock: connecting, the latency of each
+ * command, entries of list requests that arrive one by one after the request was
+ * acknowledged, and the state-change flag in the beacon. Failures can be injected per
+ * command. Library calls may come from the BLE worker, the test itself runs on the main
+ * thread, so every access is serialized.
+ */
+class SmartLock
+{
+    public:
+        static SmartLock &instance();
+
+        // Factory state: paired, locked, empty lists, default timing, zeroed counters
+        void reset();
+        void reset_stats();
+
+        // Timing of the radio link and the lock, in virtual milliseconds
+        uint32_t connect_millis = 600;
+        uint32_t command_millis = 150;
+        uint32_t entry_millis = 40;
+        uint32_t transition_millis = 1500;
+        uint32_t advertising_millis = 500;
+
+        bool ultra = false;
+        bool paired = true;
+        uint8_t battery_percent = 80;
+        int rssi = -60;
+
+        // Fails the next count commands with result
+        void fail_next(uint32_t count, Nuki::CmdResult result = Nuki::CmdResult::TimeOut);
+        // Fails every nth command with result, 0 disables
+        void fail_every(uint32_t nth, Nuki::CmdResult result = Nuki::CmdResult::TimeOut);
+
+        // Result and duration of one command, connecting included
+        struct Outcome
+        {
+            Nuki::CmdResult result;
+            uint32_t duration_millis;
+        };
+        // The next commands take these outcomes in order instead of the timing and failures above,
+        // used to replay the link conditions of a recorded trace
+        void script(const std::deque<Outcome> &outcomes);
+
+        // Things happening at the door or in the Nuki app
+        void turn(NukiLock::LockState state, NukiLock::Trigger trigger = NukiLock::Trigger::Manual);
+        void change_config(const NukiLock::Config &config);
+        void change_advanced_config(const NukiLock::AdvancedConfig &config);
+        void add_log_entry(NukiLock::LoggingType type, uint32_t auth_id, const char *name, NukiLock::LockAction action);
+        void add_auth_entry(uint32_t auth_id, const char *name);
+        void add_keypad_entry(uint16_t code_id, const char *name, uint32_t code, bool enabled = true);
+
+        // Advances the lock to now and advertises when due, called once per loop by the harness
+        void tick();
+        // Sends one beacon to all scanners right away
+        void advertise();
+
+        NukiLock::LockState get_state();
+        NukiLock::Config get_config();
+        NukiLock::AdvancedConfig get_advanced_config();
+        uint8_t get_config_update_count();
+        size_t get_log_size();
+        size_t get_keypad_size();
+        bool is_connected();
+
+        struct Stats
+        {
+            uint32_t commands = 0;
+            uint32_t failures = 0;
+            uint32_t connects = 0;
+            uint32_t disconnects = 0;
+            uint32_t beacons = 0;
+            uint32_t lock_actions = 0;
+            uint32_t status_requests = 0;
+            uint32_t config_requests = 0;
+            uint32_t config_writes = 0;
+            uint32_t list_requests = 0;
+            uint32_t keypad_writes = 0;
+            // Calls of updateConnectionState()
+            uint32_t connection_checks = 0;
+            // Longest gap between two commands of one connection
+            uint32_t max_idle_connected_millis = 0;
+        };
+        Stats get_stats();
+
+        // Used by the fake library only
+
+        Nuki::CmdResult begin_command(uint32_t Stats::*counter);
+        void fill_state(NukiLock::KeyTurnerState *state);
+        void lock_action(NukiLock::LockAction action);
+        void write_config(const NukiLock::Config *config, const NukiLock::AdvancedConfig *advanced_config);
+        void request_log(uint32_t start_index, uint16_t count, bool newest_first);
+        void request_auth(uint16_t offset, uint16_t count);
+        void request_keypad(uint16_t offset, uint16_t count);
+        void received_log(std::list<NukiLock::LogEntry> *list);
+        void received_auth(std::list<NukiLock::AuthorizationEntry> *list);
+        void received_keypad(std::list<NukiLock::KeypadEntry> *list);
+        Nuki::CmdResult keypad_add(const NukiLock::NewKeypadEntry &entry);
+        Nuki::CmdResult keypad_update(const NukiLock::UpdatedKeypadEntry &entry);
+        Nuki::CmdResult keypad_delete(uint16_t code_id);
+        void update_connection();
+        void disconnect();
+        void set_disconnect_timeout(uint32_t timeout) { this->disconnect_timeout_ = timeout; }
+
+        void add_scanner(BleScanner::Scanner *scanner);
+        void remove_scanner(BleScanner::Scanner *scanner);
+
+        uint32_t pin = 0;
+
+    protected:
+        void advance_transition_();
+        void change_state_(NukiLock::LockState state, NukiLock::LockAction action, NukiLock::Trigger trigger);
+
+        std::recursive_mutex mutex_;
+        std::vector<BleScanner::Scanner *> scanners_;
+
+        NukiLock::LockState state_;
+        NukiLock::LockState target_state_;
+        uint32_t transition_end_ = 0;
+        NukiLock::LockAction last_action_;
+        NukiLock::Trigger last_trigger_;
+        bool state_changed_ = false;
+        uint32_t next_advertisement_ = 0;
+
+        NukiLock::Config config_;
+        NukiLock::AdvancedConfig advanced_config_;
+        uint8_t config_update_count_ = 0;
+
+        std::vector<NukiLock::LogEntry> log_;
+        std::map<uint32_t, NukiLock::AuthorizationEntry> auth_;
+        std::map<uint16_t, NukiLock::KeypadEntry> keypad_;
+        uint16_t next_keypad_id_ = 1;
+
+        std::vector<Pending<NukiLock::LogEntry>> log_result_;
+        std::vector<Pending<NukiLock::AuthorizationEntry>> auth_result_;
+        std::vector<Pending<NukiLock::KeypadEntry>> keypad_result_;
+
+        bool connected_ = false;
+        uint32_t last_activity_ = 0;
+        uint32_t disconnect_timeout_ = 2000;
+
+        uint32_t fail_next_ = 0;
+        uint32_t fail_every_ = 0;
+        Nuki::CmdResult fail_next_result_ = Nuki::CmdResult::TimeOut;
+        Nuki::CmdResult fail_every_result_ = Nuki::CmdResult::TimeOut;
+        std::deque<Outcome> script_;
+
+        Stats stats_;
+};
+
+} //namespace nuki_fake
@@ -0,0 +1,139 @@
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include "harness.h"
+
+namespace esphome {
+namespace nuki_lock {
+extern uint32_t global_nuki_lock_id;
+} //namespace nuki_lock
+} //namespace esphome
+
+namespace nuki_test {
+
+Node::Node(const NodeOptions &options) : options_(options), lock_(new TestNukiLock()) {
+    TestNukiLock &lock = *this->lock_;
+    lock.set_update_interval(options.update_interval);
+    lock.set_async_commands(options.async_commands);
+    lock.set_event_driven(options.event_driven);
+    lock.set_event(options.send_events ? "nuki" : "esphome.none");
+    if (options.security_pin != 0) {
+        lock.set_security_pin_config(options.security_pin);
+    }
+    lock.set_pairing_mode_timeout(300);
+    lock.set_query_interval_config(3600);
+    lock.set_query_interval_auth_data(7200);
+    lock.set_ble_general_timeout(3);
+    lock.set_ble_command_timeout(3);
+
+    lock.set_battery_level_sensor(&this->battery_level);
+    lock.set_ble_commands_sensor(&this->ble_commands);
+    lock.set_connects_saved_sensor(&this->connects_saved);
+    lock.set_lock_action_latency_sensor(&this->lock_action_latency);
+    lock.set_lock_action_delay_sensor(&this->lock_action_delay);
+    lock.set_status_queries_avoided_sensor(&this->status_queries_avoided);
+    lock.set_connected_binary_sensor(&this->connected);
+    lock.set_paired_binary_sensor(&this->paired);
+    lock.set_last_unlock_user_text_sensor(&this->last_unlock_user);
+    lock.set_pin_state_text_sensor(&this->pin_state);
+}
+
+Node::~Node() {
+    if (this->options_.async_commands) {
+        // The worker thread cannot be stopped and keeps using the component, leave it alive
+        esphome::App.scheduler.cancel_all(this->lock_);
+        return;
+    }
+    delete this->lock_;
+}
+
+void Node::setup() {
+    if (this->options_.pin_validated) {
+        esphome::nuki_lock::NukiLockSettings settings = {0, esphome::nuki_lock::PinState::Valid};
+        esphome::global_preferences->make_preference<esphome::nuki_lock::NukiLockSettings>(
+            esphome::nuki_lock::global_nuki_lock_id).save(&settings);
+    }
+    this->lock_->call_setup();
+}
+
+void Node::step() {
+    esphome::App.scheduler.call();
+    this->lock_->loop();
+    SmartLock::instance().tick();
+
+    // While the worker runs a transaction its delays advance the clock. Advancing it here
+    // as well would let the loop race through virtual time before the worker was even scheduled.
+    if (!this->lock_->is_worker_idle()) {
+        std::this_thread::yield();
+        return;
+    }
+    esphome::advance_millis(LOOP_INTERVAL_MILLIS);
+}
+
+void Node::run_for(uint32_t duration_millis) {
+    const uint32_t start = millis();
+    while (millis() - start < duration_millis) {
+        this->step();
+    }
+}
+
+bool Node::run_until(const std::function<bool()> &condition, uint32_t timeout_millis) {
+    const uint32_t start = millis();
+    while (!condition()) {
+        if (millis() - start >= timeout_millis) {
+            return false;
+        }
+        this->step();
+    }
+    return true;
+}
+
+void reset_world() {
+    // Timestamps start at boot like on a device, leaked async nodes have no scheduled items left
+    esphome::reset_millis();
+    esphome::global_preferences->reset();
+    esphome::App.reset();
+    SmartLock::instance().reset();
+    SmartLock::instance().pin = TEST_SECURITY_PIN;
+}
+
+std::vector<TestCase> &test_cases() {
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+struct TestFailure : std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+void fail(const char *file, int line, const std::string &message) {
+    throw TestFailure(std::string(file) + ":" + std::to_string(line) + ": " + message);
+}
+
+int run_tests(int argc, char **argv) {
+    int failed = 0;
+    int ran = 0;
+
+    for (const TestCase &test : test_cases()) {
+        if (argc > 1 && strcmp(argv[1], test.name) != 0) {
+            continue;
+        }
+
+        reset_world();
+        ran++;
+        try {
+            test.run();
+            printf("[ PASS ] %s\n", test.name);
+        } catch (const TestFailure &failure) {
+            printf("[ FAIL ] %s\n  %s\n", test.name, failure.what());
+            failed++;
+        }
+    }
+
+    printf("%d of %d tests passed\n", ran - failed, ran);
+    return failed == 0 && ran > 0 ? 0 : 1;
+}
+
+} //namespace nuki_test
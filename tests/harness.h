@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "esphome/core/application.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/preferences.h"
+
+#include "nuki_lock.h"
+#include "nuki_fake.h"
+
+namespace nuki_test {
+
+using esphome::millis;
+using nuki_fake::SmartLock;
+
+// Loop interval of an idle ESPHome node
+static const uint32_t LOOP_INTERVAL_MILLIS = 16;
+// Update interval the lock platform defaults to
+static const uint32_t DEFAULT_UPDATE_INTERVAL_MILLIS = 500;
+// PIN of the simulated lock and the component
+static const uint32_t TEST_SECURITY_PIN = 1234;
+
+// Gives tests access to the internals they measure
+class TestNukiLock : public esphome::nuki_lock::NukiLockComponent
+{
+    public:
+        bool is_worker_idle() const { return this->ble_worker_.is_idle(); }
+        bool is_session_open() const { return this->session_open_; }
+        uint32_t get_scanner_updates() const { return this->scanner_.get_updates(); }
+        const esphome::nuki_lock::CommandTrace &get_command_trace() const { return this->command_trace_; }
+        using esphome::nuki_lock::NukiLockComponent::process_log_entries;
+};
+
+struct NodeOptions
+{
+    bool async_commands = false;
+    bool event_driven = false;
+    bool send_events = true;
+    uint32_t security_pin = TEST_SECURITY_PIN;
+    // The PIN was validated in an earlier boot, otherwise the node boots like after a fresh flash
+    bool pin_validated = true;
+    uint32_t update_interval = DEFAULT_UPDATE_INTERVAL_MILLIS;
+};
+
+/**
+ * @brief An ESPHome node running the component against the simulated lock.
+ *
+ * Drives the loop like the ESPHome application does: scheduler, loop(), and the
+ * simulated lock advertising in between, one LOOP_INTERVAL_MILLIS step at a time.
+ */
+class Node
+{
+    public:
+        explicit Node(const NodeOptions &options = NodeOptions());
+        ~Node();
+
+        void setup();
+        // One iteration of the application loop
+        void step();
+        void run_for(uint32_t duration_millis);
+        // Runs until condition holds, returns false on timeout
+        bool run_until(const std::function<bool()> &condition, uint32_t timeout_millis);
+
+        TestNukiLock &lock() { return *this->lock_; }
+
+        esphome::sensor::Sensor battery_level;
+        esphome::sensor::Sensor ble_commands;
+        esphome::sensor::Sensor connects_saved;
+        esphome::sensor::Sensor lock_action_latency;
+        esphome::sensor::Sensor lock_action_delay;
+        esphome::sensor::Sensor status_queries_avoided;
+        esphome::binary_sensor::BinarySensor connected;
+        esphome::binary_sensor::BinarySensor paired;
+        esphome::text_sensor::TextSensor last_unlock_user;
+        esphome::text_sensor::TextSensor pin_state;
+
+    protected:
+        NodeOptions options_;
+        TestNukiLock *lock_;
+};
+
+// Factory state for the next test: erased flash, reset simulated lock, clock at boot
+void reset_world();
+
+// Minimal test runner, no external framework needed
+
+struct TestCase
+{
+    const char *name;
+    void (*run)();
+};
+
+std::vector<TestCase> &test_cases();
+void fail(const char *file, int line, const std::string &message);
+int run_tests(int argc, char **argv);
+
+struct TestRegistrar
+{
+    TestRegistrar(const char *name, void (*run)()) { test_cases().push_back({name, run}); }
+};
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static ::nuki_test::TestRegistrar name##_registrar(#name, name); \
+    static void name()
+
+template<typename T> std::string to_string(const T &value) { return std::to_string(value); }
+inline std::string to_string(const std::string &value) { return "\"" + value + "\""; }
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            ::nuki_test::fail(__FILE__, __LINE__, "CHECK(" #condition ")"); \
+        } \
+    } while (0)
+
+#define CHECK_OP(a, op, b) \
+    do { \
+        const auto check_a_ = (a); \
+        const auto check_b_ = (b); \
+        if (!(check_a_ op check_b_)) { \
+            ::nuki_test::fail(__FILE__, __LINE__, std::string(#a " " #op " " #b ": ") + \
+                ::nuki_test::to_string(check_a_) + " vs " + ::nuki_test::to_string(check_b_)); \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) CHECK_OP(a, ==, b)
+#define CHECK_LE(a, b) CHECK_OP(a, <=, b)
+#define CHECK_GE(a, b) CHECK_OP(a, >=, b)
+
+} //namespace nuki_test
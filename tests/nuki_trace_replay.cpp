@@ -0,0 +1,62 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include "trace_replay.h"
+
+// Summarizes a command trace dumped by the print_command_trace service and replays
+// it against the component, see README.md -> Development.
+
+static int usage(const char *name) {
+    fprintf(stderr, "usage: %s [--async] [--event-driven] [--no-replay] <log file or ->\n", name);
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    nuki_test::NodeOptions options;
+    bool run_replay = true;
+    const char *path = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--async") == 0) {
+            options.async_commands = true;
+        } else if (strcmp(argv[i], "--event-driven") == 0) {
+            options.event_driven = true;
+        } else if (strcmp(argv[i], "--no-replay") == 0) {
+            run_replay = false;
+        } else if (path == nullptr && (argv[i][0] != '-' || strcmp(argv[i], "-") == 0)) {
+            path = argv[i];
+        } else {
+            return usage(argv[0]);
+        }
+    }
+    if (path == nullptr) {
+        return usage(argv[0]);
+    }
+
+    std::vector<nuki_test::TraceEntry> trace;
+    if (strcmp(path, "-") == 0) {
+        trace = nuki_test::parse_trace(std::cin);
+    } else {
+        std::ifstream input(path);
+        if (!input) {
+            fprintf(stderr, "Cannot open %s\n", path);
+            return 1;
+        }
+        trace = nuki_test::parse_trace(input);
+    }
+
+    if (trace.empty()) {
+        fprintf(stderr, "No trace records found, expected lines like trace,<timestamp>,<call>,<result>,<duration>\n");
+        return 1;
+    }
+
+    const nuki_test::TraceSummary recorded = nuki_test::summarize(trace);
+    nuki_test::print_summary(stdout, "recorded", recorded);
+
+    if (run_replay) {
+        const nuki_test::ReplayResult replayed = nuki_test::replay(trace, options);
+        nuki_test::print_replay(stdout, recorded, replayed);
+    }
+    return 0;
+}
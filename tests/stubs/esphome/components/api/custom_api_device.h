@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace api {
+
+/**
+ * @brief Registered services can be called by name like Home Assistant would,
+ * fired Home Assistant events are recorded.
+ */
+class CustomAPIDevice
+{
+    public:
+        template<typename T, typename... Ts>
+        void register_service(void (T::*callback)(Ts...), const std::string &name,
+                              const std::array<std::string, sizeof...(Ts)> &arg_names) {
+            auto service = std::make_shared<Service<Ts...>>();
+            T *obj = static_cast<T *>(this);
+            service->call = [obj, callback](Ts... x) { (obj->*callback)(x...); };
+            this->services_[name] = service;
+        }
+
+        template<typename T> void register_service(void (T::*callback)(), const std::string &name) {
+            this->register_service(callback, name, {});
+        }
+
+        // Arguments must have the exact types of the service, returns false for unknown services
+        template<typename... Ts> bool call_service(const std::string &name, Ts... x) {
+            auto it = this->services_.find(name);
+            if (it == this->services_.end()) {
+                return false;
+            }
+            auto *service = dynamic_cast<Service<Ts...> *>(it->second.get());
+            if (service == nullptr) {
+                return false;
+            }
+            service->call(x...);
+            return true;
+        }
+
+        void fire_homeassistant_event(const std::string &event_name, const std::map<std::string, std::string> &data = {}) {
+            this->fired_event_count_++;
+            if (this->record_events_) {
+                this->fired_events_.push_back({event_name, data});
+            }
+        }
+
+        struct FiredEvent
+        {
+            std::string name;
+            std::map<std::string, std::string> data;
+        };
+
+        const std::vector<FiredEvent> &get_fired_events() const { return this->fired_events_; }
+        size_t get_fired_event_count() const { return this->fired_event_count_; }
+        // Recording copies the data, turned off where allocations are measured
+        void set_record_events(bool record) { this->record_events_ = record; }
+
+    protected:
+        struct ServiceBase
+        {
+            virtual ~ServiceBase() {}
+        };
+
+        template<typename... Ts> struct Service : ServiceBase
+        {
+            std::function<void(Ts...)> call;
+        };
+
+        std::map<std::string, std::shared_ptr<ServiceBase>> services_;
+        std::vector<FiredEvent> fired_events_;
+        size_t fired_event_count_ = 0;
+        bool record_events_ = true;
+};
+
+} //namespace api
+} //namespace esphome
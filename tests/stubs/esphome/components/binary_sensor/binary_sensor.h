@@ -0,0 +1,36 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace binary_sensor {
+
+class BinarySensor : public EntityBase
+{
+    public:
+        void publish_state(bool state) {
+            this->state = state;
+            this->has_state_ = true;
+            this->count_publish();
+        }
+        void publish_initial_state(bool state) { this->publish_state(state); }
+        void invalidate_state() { this->has_state_ = false; }
+        bool has_state() const { return this->has_state_; }
+
+        bool state{false};
+
+    protected:
+        bool has_state_{false};
+};
+
+} //namespace binary_sensor
+} //namespace esphome
+
+#define SUB_BINARY_SENSOR(name) \
+    protected: \
+        binary_sensor::BinarySensor *name##_binary_sensor_{nullptr}; \
+\
+    public: \
+        void set_##name##_binary_sensor(binary_sensor::BinarySensor *binary_sensor) { this->name##_binary_sensor_ = binary_sensor; }
+
+#define LOG_BINARY_SENSOR(prefix, type, obj) ::esphome::log_entity(TAG, prefix, type, obj)
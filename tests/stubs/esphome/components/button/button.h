@@ -0,0 +1,27 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace button {
+
+class Button : public EntityBase
+{
+    public:
+        void press() { this->press_action(); }
+
+    protected:
+        virtual void press_action() = 0;
+};
+
+} //namespace button
+} //namespace esphome
+
+#define SUB_BUTTON(name) \
+    protected: \
+        button::Button *name##_button_{nullptr}; \
+\
+    public: \
+        void set_##name##_button(button::Button *button) { this->name##_button_ = button; }
+
+#define LOG_BUTTON(prefix, type, obj) ::esphome::log_entity(TAG, prefix, type, obj)
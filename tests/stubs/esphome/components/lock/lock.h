@@ -0,0 +1,69 @@
+#pragma once
+
+#include <set>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace lock {
+
+enum LockState : uint8_t
+{
+    LOCK_STATE_NONE = 0,
+    LOCK_STATE_LOCKED = 1,
+    LOCK_STATE_UNLOCKED = 2,
+    LOCK_STATE_JAMMED = 3,
+    LOCK_STATE_LOCKING = 4,
+    LOCK_STATE_UNLOCKING = 5
+};
+
+class LockTraits
+{
+    public:
+        bool get_supports_open() const { return this->supports_open_; }
+        void set_supports_open(bool supports_open) { this->supports_open_ = supports_open; }
+        void set_supported_states(std::set<LockState> states) { this->supported_states_ = std::move(states); }
+
+    protected:
+        bool supports_open_{false};
+        std::set<LockState> supported_states_;
+};
+
+class LockCall
+{
+    public:
+        explicit LockCall(LockState state) : state_(state) {}
+        const LockState *get_state() const { return &this->state_; }
+
+    protected:
+        LockState state_;
+};
+
+class Lock : public EntityBase
+{
+    public:
+        void publish_state(LockState state) {
+            this->state = state;
+            this->count_publish();
+        }
+
+        void lock() { this->control(LockCall(LOCK_STATE_LOCKED)); }
+        void unlock() { this->control(LockCall(LOCK_STATE_UNLOCKED)); }
+        void open() {
+            if (this->traits.get_supports_open()) {
+                this->open_latch();
+            }
+        }
+
+        LockState state{LOCK_STATE_NONE};
+        LockTraits traits;
+
+    protected:
+        virtual void control(const LockCall &call) = 0;
+        virtual void open_latch() {}
+};
+
+} //namespace lock
+} //namespace esphome
+
+#define LOG_LOCK(prefix, type, obj) ::esphome::log_entity(TAG, prefix, type, obj)
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cmath>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace number {
+
+class Number : public EntityBase
+{
+    public:
+        void publish_state(float state) {
+            this->state = state;
+            this->count_publish();
+        }
+        // Stands in for make_call().set_value(value).perform()
+        void set(float value) { this->control(value); }
+
+        float state{NAN};
+
+    protected:
+        virtual void control(float value) = 0;
+};
+
+} //namespace number
+} //namespace esphome
+
+#define SUB_NUMBER(name) \
+    protected: \
+        number::Number *name##_number_{nullptr}; \
+\
+    public: \
+        void set_##name##_number(number::Number *number) { this->name##_number_ = number; }
+
+#define LOG_NUMBER(prefix, type, obj) ::esphome::log_entity(TAG, prefix, type, obj)
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace select {
+
+class Select : public EntityBase
+{
+    public:
+        void publish_state(const std::string &state) {
+            this->state = state;
+            this->count_publish();
+        }
+        // Stands in for make_call().set_option(value).perform()
+        void set(const std::string &value) { this->control(value); }
+
+        std::string state;
+
+    protected:
+        virtual void control(const std::string &value) = 0;
+};
+
+} //namespace select
+} //namespace esphome
+
+#define SUB_SELECT(name) \
+    protected: \
+        select::Select *name##_select_{nullptr}; \
+\
+    public: \
+        void set_##name##_select(select::Select *select) { this->name##_select_ = select; }
+
+#define LOG_SELECT(prefix, type, obj) ::esphome::log_entity(TAG, prefix, type, obj)
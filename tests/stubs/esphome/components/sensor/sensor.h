@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cmath>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace sensor {
+
+class Sensor : public EntityBase
+{
+    public:
+        void publish_state(float state) {
+            this->state = state;
+            this->count_publish();
+        }
+        void publish_initial_state(float state) { this->publish_state(state); }
+        void invalidate_state() { this->state = NAN; }
+        bool has_state() const { return !std::isnan(this->state); }
+
+        float state{NAN};
+};
+
+} //namespace sensor
+} //namespace esphome
+
+#define SUB_SENSOR(name) \
+    protected: \
+        sensor::Sensor *name##_sensor_{nullptr}; \
+\
+    public: \
+        void set_##name##_sensor(sensor::Sensor *sensor) { this->name##_sensor_ = sensor; }
+
+#define LOG_SENSOR(prefix, type, obj) ::esphome::log_entity(TAG, prefix, type, obj)
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace switch_ {
+
+class Switch : public EntityBase
+{
+    public:
+        void publish_state(bool state) {
+            this->state = state;
+            this->count_publish();
+        }
+        void turn_on() { this->write_state(true); }
+        void turn_off() { this->write_state(false); }
+
+        bool state{false};
+
+    protected:
+        virtual void write_state(bool state) = 0;
+};
+
+} //namespace switch_
+} //namespace esphome
+
+#define SUB_SWITCH(name) \
+    protected: \
+        switch_::Switch *name##_switch_{nullptr}; \
+\
+    public: \
+        void set_##name##_switch(switch_::Switch *s) { this->name##_switch_ = s; }
+
+#define LOG_SWITCH(prefix, type, obj) ::esphome::log_entity(TAG, prefix, type, obj)
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor : public EntityBase
+{
+    public:
+        void publish_state(const std::string &state) {
+            this->state = state;
+            this->has_state_ = true;
+            this->count_publish();
+        }
+        void publish_initial_state(const std::string &state) { this->publish_state(state); }
+        void invalidate_state() { this->has_state_ = false; }
+        bool has_state() const { return this->has_state_; }
+
+        std::string state;
+
+    protected:
+        bool has_state_{false};
+};
+
+} //namespace text_sensor
+} //namespace esphome
+
+#define SUB_TEXT_SENSOR(name) \
+    protected: \
+        text_sensor::TextSensor *name##_text_sensor_{nullptr}; \
+\
+    public: \
+        void set_##name##_text_sensor(text_sensor::TextSensor *text_sensor) { this->name##_text_sensor_ = text_sensor; }
+
+#define LOG_TEXT_SENSOR(prefix, type, obj) ::esphome::log_entity(TAG, prefix, type, obj)
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+
+class Application
+{
+    public:
+        void feed_wdt() {}
+        void safe_reboot() { this->reboot_requested_ = true; }
+
+        bool is_reboot_requested() const { return this->reboot_requested_; }
+        void reset() { this->reboot_requested_ = false; }
+
+        Scheduler scheduler;
+
+    protected:
+        bool reboot_requested_ = false;
+};
+
+extern Application App;
+
+} //namespace esphome
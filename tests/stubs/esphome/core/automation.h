@@ -0,0 +1,38 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+
+template<typename... Ts> class Action
+{
+    public:
+        virtual ~Action() {}
+        virtual void play(const Ts &...x) = 0;
+};
+
+template<typename... Ts> class Condition
+{
+    public:
+        virtual ~Condition() {}
+        virtual bool check(const Ts &...x) = 0;
+};
+
+template<typename... Ts> class Trigger
+{
+    public:
+        void trigger(const Ts &...x) { this->triggered_++; }
+        uint32_t get_triggered() const { return this->triggered_; }
+
+    protected:
+        uint32_t triggered_ = 0;
+};
+
+#define TEMPLATABLE_VALUE(type, name) \
+    protected: \
+        TemplatableValue<type, Ts...> name##_{}; \
+\
+    public: \
+        template<typename V> void set_##name(V name) { this->name##_ = name; }
+
+} //namespace esphome
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+
+namespace setup_priority {
+extern const float HARDWARE;
+extern const float DATA;
+} //namespace setup_priority
+
+enum class RetryResult
+{
+    DONE,
+    RETRY
+};
+
+class Component;
+
+/**
+ * @brief Timeouts, intervals and retries of the host build, run from the harness loop.
+ *
+ * Follows the ESPHome scheduler: a named item replaces the previous item with the same
+ * name of the same component, and items may be cancelled from their own callback.
+ */
+class Scheduler
+{
+    public:
+        enum class Type : uint8_t
+        {
+            Timeout,
+            Interval,
+            Retry
+        };
+
+        void set(Component *component, Type type, const std::string &name, uint32_t delay, uint32_t interval,
+                 std::function<void()> &&callback);
+        bool cancel(Component *component, Type type, const std::string &name);
+        void cancel_all(Component *component);
+
+        // Runs every item that is due, returns how many ran
+        size_t call();
+        // Items waiting to run
+        size_t size() const;
+
+    protected:
+        struct Item
+        {
+            Component *component;
+            Type type;
+            std::string name;
+            uint32_t next;
+            uint32_t interval;
+            uint64_t order;
+            std::function<void()> callback;
+            bool removed;
+        };
+
+        std::vector<std::shared_ptr<Item>> items_;
+        uint64_t order_ = 0;
+};
+
+class Component
+{
+    public:
+        virtual ~Component();
+
+        virtual void setup() {}
+        virtual void loop() {}
+        virtual void dump_config() {}
+        virtual float get_setup_priority() const { return 0.0f; }
+        virtual void on_safe_shutdown() {}
+        virtual void on_shutdown() {}
+
+        // Runs setup(), PollingComponent also starts its update interval
+        virtual void call_setup() { this->setup(); }
+
+        void mark_failed() { this->failed_ = true; }
+        bool is_failed() const { return this->failed_; }
+
+    protected:
+        void set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f);
+        void set_interval(uint32_t interval, std::function<void()> &&f);
+        bool cancel_interval(const std::string &name);
+        void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f);
+        void set_timeout(uint32_t timeout, std::function<void()> &&f);
+        bool cancel_timeout(const std::string &name);
+        void set_retry(const std::string &name, uint32_t initial_wait_time, uint8_t max_attempts,
+                       std::function<RetryResult(uint8_t)> &&f, float backoff_increase_factor = 1.0f);
+        bool cancel_retry(const std::string &name);
+        void defer(const std::string &name, std::function<void()> &&f);
+        void defer(std::function<void()> &&f);
+
+        bool failed_ = false;
+};
+
+class PollingComponent : public Component
+{
+    public:
+        PollingComponent() : PollingComponent(0) {}
+        explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+
+        virtual void update() = 0;
+
+        void call_setup() override;
+        void set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+        uint32_t get_update_interval() const { return this->update_interval_; }
+        void start_poller();
+        void stop_poller();
+
+    protected:
+        uint32_t update_interval_;
+};
+
+class EntityBase
+{
+    public:
+        const std::string &get_name() const { return this->name_; }
+        void set_name(const std::string &name) { this->name_ = name; }
+
+        // States published by this entity, not part of the ESPHome API
+        uint32_t get_publishes() const { return this->publishes_; }
+        // States published by all entities
+        static uint32_t get_total_publishes() { return total_publishes_; }
+
+    protected:
+        void count_publish() {
+            this->publishes_++;
+            total_publishes_++;
+        }
+
+        std::string name_;
+        uint32_t publishes_ = 0;
+        static uint32_t total_publishes_;
+};
+
+// Body of the LOG_* entity macros
+template<typename T> void log_entity(const char *tag, const char *prefix, const char *type, const T *obj) {
+    if (obj != nullptr) {
+        ESP_LOGCONFIG(tag, "%s%s '%s'", prefix, type, obj->get_name().c_str());
+    }
+}
+
+} //namespace esphome
@@ -0,0 +1,3 @@
+#pragma once
+
+// Feature flags come from the compiler command line, see tests/CMakeLists.txt
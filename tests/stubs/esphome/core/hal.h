@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+
+// Virtual time of the host build. delay() advances it instead of sleeping,
+// the test harness advances it between loop iterations.
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+void advance_millis(uint32_t ms);
+// Back to boot time, components of earlier tests must be gone
+void reset_millis();
+
+} //namespace esphome
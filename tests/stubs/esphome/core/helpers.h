@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace esphome {
+
+template<class T> class RAMAllocator
+{
+    public:
+        using value_type = T;
+
+        enum Flags
+        {
+            NONE = 0,
+            ALLOC_EXTERNAL = 1 << 0,
+            ALLOC_INTERNAL = 1 << 1,
+            ALLOW_FAILURE = 1 << 2,
+        };
+
+        RAMAllocator() = default;
+        RAMAllocator(uint8_t flags) {}
+        template<class U> constexpr RAMAllocator(const RAMAllocator<U> &other) {}
+
+        T *allocate(size_t n) { return static_cast<T *>(malloc(n * sizeof(T))); }
+        void deallocate(T *p, size_t n) { free(p); }
+};
+
+template<class T> using ExternalRAMAllocator = RAMAllocator<T>;
+
+template<typename... X> class CallbackManager;
+
+template<typename... Ts> class CallbackManager<void(Ts...)>
+{
+    public:
+        void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+        void call(Ts... args) {
+            for (auto &callback : this->callbacks_) {
+                callback(args...);
+            }
+        }
+        size_t size() const { return this->callbacks_.size(); }
+
+    protected:
+        std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+template<typename T> class Parented
+{
+    public:
+        Parented() {}
+        Parented(T *parent) : parent_(parent) {}
+
+        T *get_parent() const { return this->parent_; }
+        void set_parent(T *parent) { this->parent_ = parent; }
+
+    protected:
+        T *parent_{nullptr};
+};
+
+template<typename T, typename... X> class TemplatableValue
+{
+    public:
+        TemplatableValue() {}
+        TemplatableValue(T value) : value_(value), has_value_(true) {}
+        template<typename F, typename = decltype(std::declval<F>()(std::declval<X>()...))>
+        TemplatableValue(F f) : f_(f), has_value_(true) {}
+
+        bool has_value() const { return this->has_value_; }
+
+        T value(X... x) { return this->f_ ? this->f_(x...) : this->value_; }
+
+        T value_or(X... x, T default_value) {
+            return this->has_value_ ? this->value(x...) : default_value;
+        }
+
+    protected:
+        T value_{};
+        std::function<T(X...)> f_;
+        bool has_value_{false};
+};
+
+} //namespace esphome
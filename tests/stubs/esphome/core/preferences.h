@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+namespace esphome {
+
+/**
+ * @brief In-memory flash of the host build.
+ *
+ * Survives the component, so a second component instance boots from what the
+ * first one saved, like after a reboot.
+ */
+class ESPPreferences
+{
+    public:
+        bool save(uint32_t type, const uint8_t *data, size_t len);
+        bool load(uint32_t type, uint8_t *data, size_t len);
+        bool sync() { return true; }
+
+        // Erases the flash, not part of the ESPHome API
+        void reset();
+        uint32_t get_writes() const { return this->writes_; }
+
+        template<typename T> class ESPPreferenceObject make_preference(uint32_t type, bool in_flash = false);
+
+    protected:
+        std::map<uint32_t, std::vector<uint8_t>> data_;
+        uint32_t writes_ = 0;
+};
+
+extern ESPPreferences *global_preferences;
+
+class ESPPreferenceObject
+{
+    public:
+        ESPPreferenceObject() = default;
+        ESPPreferenceObject(uint32_t type) : type_(type), valid_(true) {}
+
+        template<typename T> bool save(const T *src) {
+            return this->valid_ && global_preferences->save(this->type_, reinterpret_cast<const uint8_t *>(src), sizeof(T));
+        }
+
+        template<typename T> bool load(T *dest) {
+            return this->valid_ && global_preferences->load(this->type_, reinterpret_cast<uint8_t *>(dest), sizeof(T));
+        }
+
+    protected:
+        uint32_t type_ = 0;
+        bool valid_ = false;
+};
+
+template<typename T> ESPPreferenceObject ESPPreferences::make_preference(uint32_t type, bool in_flash) {
+    return ESPPreferenceObject(type);
+}
+
+} //namespace esphome
@@ -0,0 +1,317 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+#include "esphome/core/application.h"
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include "esphome/core/preferences.h"
+
+namespace esphome {
+
+// Clock
+
+static std::atomic<uint32_t> virtual_millis{0};
+
+uint32_t millis() {
+    return virtual_millis.load();
+}
+
+uint32_t micros() {
+    return virtual_millis.load() * 1000;
+}
+
+void delay(uint32_t ms) {
+    virtual_millis += ms;
+}
+
+void delayMicroseconds(uint32_t us) {
+    virtual_millis += (us + 999) / 1000;
+}
+
+void advance_millis(uint32_t ms) {
+    virtual_millis += ms;
+}
+
+void reset_millis() {
+    virtual_millis = 0;
+}
+
+static bool is_due(uint32_t now, uint32_t time) {
+    return static_cast<int32_t>(now - time) >= 0;
+}
+
+// Log
+
+static int log_level = -1;
+static std::atomic<unsigned> log_counts[ESPHOME_LOG_LEVEL_VERBOSE + 1];
+
+int get_log_level() {
+    if (log_level < 0) {
+        const char *level = getenv("NUKI_TEST_LOG_LEVEL");
+        log_level = level != nullptr ? atoi(level) : ESPHOME_LOG_LEVEL_WARN;
+    }
+    return log_level;
+}
+
+void set_log_level(int level) {
+    log_level = level;
+}
+
+unsigned get_log_count(int level) {
+    return level >= 0 && level <= ESPHOME_LOG_LEVEL_VERBOSE ? log_counts[level].load() : 0;
+}
+
+static LogListener log_listener;
+
+void set_log_listener(LogListener listener) {
+    log_listener = std::move(listener);
+}
+
+void esp_log_printf_(int level, const char *tag, int line, const char *format, ...) {
+    if (level >= 0 && level <= ESPHOME_LOG_LEVEL_VERBOSE) {
+        log_counts[level]++;
+    }
+    if (level > get_log_level() && !log_listener) {
+        return;
+    }
+
+    char message[512];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+
+    if (log_listener) {
+        log_listener(level, tag, message);
+    }
+    if (level > get_log_level()) {
+        return;
+    }
+
+    static const char LEVELS[] = "-EWICDV";
+    printf("[%7u][%c][%s:%d]: %s\n", millis(), LEVELS[level], tag, line, message);
+}
+
+// Preferences
+
+bool ESPPreferences::save(uint32_t type, const uint8_t *data, size_t len) {
+    this->data_[type].assign(data, data + len);
+    this->writes_++;
+    return true;
+}
+
+bool ESPPreferences::load(uint32_t type, uint8_t *data, size_t len) {
+    auto it = this->data_.find(type);
+    if (it == this->data_.end() || it->second.size() != len) {
+        return false;
+    }
+    memcpy(data, it->second.data(), len);
+    return true;
+}
+
+void ESPPreferences::reset() {
+    this->data_.clear();
+    this->writes_ = 0;
+}
+
+static ESPPreferences host_preferences;
+ESPPreferences *global_preferences = &host_preferences;
+
+// Scheduler
+
+void Scheduler::set(Component *component, Type type, const std::string &name, uint32_t delay, uint32_t interval,
+                    std::function<void()> &&callback) {
+    if (!name.empty()) {
+        this->cancel(component, type, name);
+    }
+
+    auto item = std::make_shared<Item>();
+    item->component = component;
+    item->type = type;
+    item->name = name;
+    item->next = millis() + delay;
+    item->interval = interval;
+    item->order = this->order_++;
+    item->callback = std::move(callback);
+    item->removed = false;
+    this->items_.push_back(std::move(item));
+}
+
+bool Scheduler::cancel(Component *component, Type type, const std::string &name) {
+    bool cancelled = false;
+    for (auto &item : this->items_) {
+        if (!item->removed && item->component == component && item->type == type && item->name == name) {
+            item->removed = true;
+            cancelled = true;
+        }
+    }
+    return cancelled;
+}
+
+void Scheduler::cancel_all(Component *component) {
+    for (auto &item : this->items_) {
+        if (item->component == component) {
+            item->removed = true;
+        }
+    }
+}
+
+size_t Scheduler::call() {
+    const uint32_t now = millis();
+
+    // Items added by the callbacks run on the next call, like deferred calls in ESPHome
+    std::vector<std::shared_ptr<Item>> due;
+    for (auto &item : this->items_) {
+        if (!item->removed && is_due(now, item->next)) {
+            due.push_back(item);
+        }
+    }
+    std::sort(due.begin(), due.end(), [now](const std::shared_ptr<Item> &a, const std::shared_ptr<Item> &b) {
+        if (a->next != b->next) {
+            return static_cast<int32_t>(a->next - b->next) < 0;
+        }
+        return a->order < b->order;
+    });
+
+    size_t ran = 0;
+    for (auto &item : due) {
+        // Cancelled by an earlier callback
+        if (item->removed) {
+            continue;
+        }
+
+        if (item->type == Type::Interval) {
+            item->next = now + item->interval;
+        } else {
+            item->removed = true;
+        }
+
+        // The callback may replace or cancel its own item
+        std::function<void()> callback = item->callback;
+        callback();
+        ran++;
+    }
+
+    this->items_.erase(std::remove_if(this->items_.begin(), this->items_.end(), [](const std::shared_ptr<Item> &item) {
+        return item->removed;
+    }), this->items_.end());
+
+    return ran;
+}
+
+size_t Scheduler::size() const {
+    return std::count_if(this->items_.begin(), this->items_.end(), [](const std::shared_ptr<Item> &item) {
+        return !item->removed;
+    });
+}
+
+// Component
+
+namespace setup_priority {
+const float HARDWARE = 800.0f;
+const float DATA = 600.0f;
+} //namespace setup_priority
+
+Application App;
+
+uint32_t EntityBase::total_publishes_ = 0;
+
+Component::~Component() {
+    App.scheduler.cancel_all(this);
+}
+
+void Component::set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f) {
+    App.scheduler.set(this, Scheduler::Type::Interval, name, interval, interval, std::move(f));
+}
+
+void Component::set_interval(uint32_t interval, std::function<void()> &&f) {
+    this->set_interval("", interval, std::move(f));
+}
+
+bool Component::cancel_interval(const std::string &name) {
+    return App.scheduler.cancel(this, Scheduler::Type::Interval, name);
+}
+
+void Component::set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {
+    App.scheduler.set(this, Scheduler::Type::Timeout, name, timeout, 0, std::move(f));
+}
+
+void Component::set_timeout(uint32_t timeout, std::function<void()> &&f) {
+    this->set_timeout("", timeout, std::move(f));
+}
+
+bool Component::cancel_timeout(const std::string &name) {
+    return App.scheduler.cancel(this, Scheduler::Type::Timeout, name);
+}
+
+void Component::defer(const std::string &name, std::function<void()> &&f) {
+    this->set_timeout(name, 0, std::move(f));
+}
+
+void Component::defer(std::function<void()> &&f) {
+    this->set_timeout("", 0, std::move(f));
+}
+
+struct RetryArgs
+{
+    Component *component;
+    std::string name;
+    std::function<RetryResult(uint8_t)> f;
+    uint8_t retry_countdown;
+    uint32_t current_interval;
+    float backoff_increase_factor;
+};
+
+static void retry_handler(const std::shared_ptr<RetryArgs> &args) {
+    RetryResult result = args->f(--args->retry_countdown);
+    if (result == RetryResult::DONE || args->retry_countdown <= 0) {
+        return;
+    }
+
+    App.scheduler.set(args->component, Scheduler::Type::Retry, args->name, args->current_interval, 0, [args]() {
+        retry_handler(args);
+    });
+    args->current_interval *= args->backoff_increase_factor;
+}
+
+void Component::set_retry(const std::string &name, uint32_t initial_wait_time, uint8_t max_attempts,
+                          std::function<RetryResult(uint8_t)> &&f, float backoff_increase_factor) {
+    auto args = std::make_shared<RetryArgs>();
+    args->component = this;
+    args->name = name;
+    args->f = std::move(f);
+    args->retry_countdown = max_attempts;
+    args->current_interval = initial_wait_time;
+    args->backoff_increase_factor = backoff_increase_factor;
+
+    // The first attempt runs right away
+    App.scheduler.set(this, Scheduler::Type::Retry, name, 0, 0, [args]() {
+        retry_handler(args);
+    });
+}
+
+bool Component::cancel_retry(const std::string &name) {
+    return App.scheduler.cancel(this, Scheduler::Type::Retry, name);
+}
+
+void PollingComponent::call_setup() {
+    this->setup();
+    this->start_poller();
+}
+
+void PollingComponent::start_poller() {
+    this->set_interval("update", this->get_update_interval(), [this]() {
+        this->update();
+    });
+}
+
+void PollingComponent::stop_poller() {
+    this->cancel_interval("update");
+}
+
+} //namespace esphome
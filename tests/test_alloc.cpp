@@ -0,0 +1,201 @@
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <map>
+#include <new>
+#include <string>
+
+#include "event_payload.h"
+#include "harness.h"
+
+using namespace nuki_test;
+using esphome::nuki_lock::EventPayload;
+using esphome::lock::LOCK_STATE_LOCKED;
+
+// Heap allocations of the event log path. Only allocations of the measuring thread count,
+// the BLE worker and the harness are not measured.
+
+namespace {
+
+thread_local bool counting = false;
+thread_local uint32_t allocations = 0;
+
+class AllocationCounter
+{
+    public:
+        AllocationCounter() {
+            allocations = 0;
+            counting = true;
+        }
+        ~AllocationCounter() { counting = false; }
+
+        uint32_t get() const { return allocations; }
+};
+
+// The keys and values the component sends for a lock action entry
+void fill_lock_action(EventPayload &payload, uint32_t index) {
+    payload.clear();
+    payload.add("index", index);
+    payload.add("authorizationId", 1);
+    payload.add("authorizationName", "Nuki ESPHome");
+    payload.add("timeYear", 2025);
+    payload.add("timeMonth", 6);
+    payload.add("timeDay", 1);
+    payload.add("timeHour", 12);
+    payload.add("timeMinute", 30);
+    payload.add("timeSecond", 15);
+    payload.add("type", "LockAction");
+    payload.add("action", "Unlock");
+    payload.add("trigger", "System");
+    payload.add("completionStatus", "success");
+}
+
+// The std::map the component filled per entry before EventPayload, reused across entries
+void fill_legacy_map(std::map<std::string, std::string> &data, uint32_t index) {
+    char num_buffer[16];
+    data.clear();
+    snprintf(num_buffer, sizeof(num_buffer), "%u", index);
+    data["index"] = num_buffer;
+    data["authorizationId"] = "1";
+    data["authorizationName"] = "Nuki ESPHome";
+    data["timeYear"] = "2025";
+    data["timeMonth"] = "6";
+    data["timeDay"] = "1";
+    data["timeHour"] = "12";
+    data["timeMinute"] = "30";
+    data["timeSecond"] = "15";
+    data["type"] = "LockAction";
+    data["action"] = "Unlock";
+    data["trigger"] = "System";
+    data["completionStatus"] = "success";
+}
+
+std::list<NukiLock::LogEntry> make_log(uint32_t first_index, uint32_t count) {
+    std::list<NukiLock::LogEntry> log;
+    for (uint32_t i = 0; i < count; i++) {
+        NukiLock::LogEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.index = first_index + i;
+        entry.timeStampYear = 2025;
+        entry.timeStampMonth = 6;
+        entry.timeStampDay = 1;
+        entry.timeStampHour = 12;
+        entry.timeStampMinute = 30;
+        entry.timeStampSecond = i % 60;
+        entry.authId = 1;
+        strcpy(reinterpret_cast<char *>(entry.name), "Nuki ESPHome");
+        entry.loggingType = NukiLock::LoggingType::LockAction;
+        entry.data[0] = static_cast<uint8_t>(NukiLock::LockAction::Unlock);
+        entry.data[1] = static_cast<uint8_t>(NukiLock::Trigger::System);
+        log.push_back(entry);
+    }
+    return log;
+}
+
+} //namespace
+
+// Replacements of the global allocation functions, GCC mistakes their free() for a mismatch
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void *operator new(size_t size) {
+    if (counting) {
+        allocations++;
+    }
+    void *pointer = malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void *pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t size) noexcept {
+    free(pointer);
+}
+
+#pragma GCC diagnostic pop
+
+TEST_CASE(building_a_payload_does_not_allocate) {
+    EventPayload payload;
+    AllocationCounter counter;
+    for (uint32_t i = 0; i < 100; i++) {
+        fill_lock_action(payload, i);
+    }
+    CHECK_EQ(counter.get(), 0u);
+    CHECK_EQ(payload.size(), 13u);
+}
+
+TEST_CASE(to_map_allocates_only_for_the_api) {
+    EventPayload payload;
+    fill_lock_action(payload, 1);
+    std::map<std::string, std::string> legacy;
+
+    uint32_t to_map_allocations;
+    {
+        AllocationCounter counter;
+        const std::map<std::string, std::string> data = payload.to_map();
+        to_map_allocations = counter.get();
+    }
+    uint32_t legacy_allocations;
+    {
+        fill_legacy_map(legacy, 1);
+        AllocationCounter counter;
+        fill_legacy_map(legacy, 1);
+        legacy_allocations = counter.get();
+    }
+    std::printf("lock action event: EventPayload 0, to_map() %u, legacy map %u allocations\n", to_map_allocations, legacy_allocations);
+
+    // One node per entry plus keys and values longer than the small string buffer. The legacy
+    // map was reused, clear() freed its nodes, so it allocated the same per entry.
+    CHECK(payload.to_map() == legacy);
+    CHECK_LE(to_map_allocations, legacy_allocations);
+    CHECK_GE(to_map_allocations, static_cast<uint32_t>(payload.size()));
+}
+
+TEST_CASE(component_allocates_only_at_the_send_boundary) {
+    Node node;
+    node.setup();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, 10000));
+    node.run_for(30000);
+    node.lock().set_record_events(false);
+
+    // Warm up, the first entries schedule the cache save and fill caches
+    const std::list<NukiLock::LogEntry> warm_up = make_log(1000, 1);
+    node.lock().process_log_entries(warm_up);
+
+    const std::list<NukiLock::LogEntry> one = make_log(2000, 1);
+    const std::list<NukiLock::LogEntry> many = make_log(3000, 21);
+    uint32_t one_allocations;
+    {
+        AllocationCounter counter;
+        node.lock().process_log_entries(one);
+        one_allocations = counter.get();
+    }
+    uint32_t many_allocations;
+    {
+        AllocationCounter counter;
+        node.lock().process_log_entries(many);
+        many_allocations = counter.get();
+    }
+
+    EventPayload payload;
+    fill_lock_action(payload, 1);
+    uint32_t to_map_allocations;
+    {
+        AllocationCounter counter;
+        payload.to_map();
+        to_map_allocations = counter.get();
+    }
+
+    const uint32_t per_event = (many_allocations - one_allocations) / 20;
+    std::printf("process_log_entries(): %u allocations for 1 entry, %u for 21, %u per event, to_map() %u\n",
+        one_allocations, many_allocations, per_event, to_map_allocations);
+
+    CHECK_EQ(node.lock().get_fired_event_count(), 23u + node.lock().get_fired_events().size());
+    // Every allocation per event is the map fire_homeassistant_event() takes
+    CHECK_EQ(many_allocations - one_allocations, 20 * to_map_allocations);
+}
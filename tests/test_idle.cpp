@@ -0,0 +1,91 @@
+#include <chrono>
+
+#include "harness.h"
+
+using namespace nuki_test;
+using esphome::lock::LOCK_STATE_LOCKED;
+using esphome::lock::LOCK_STATE_UNLOCKED;
+
+namespace {
+
+// Boots a node and waits until the initial refresh is done and the link is down
+void settle(Node &node) {
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, 10000));
+    node.run_for(30000);
+    CHECK(!SmartLock::instance().is_connected());
+}
+
+} //namespace
+
+TEST_CASE(idle_update_benchmark) {
+    Node node;
+    node.setup();
+    settle(node);
+
+    const SmartLock::Stats before = SmartLock::instance().get_stats();
+    const uint32_t scanner_updates = node.lock().get_scanner_updates();
+
+    // Wall clock cost of update() calls of an idle node, virtual time stands still
+    const uint32_t calls = 200000;
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < calls; i++) {
+        node.lock().update();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const double nanos = std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+
+    const SmartLock::Stats after = SmartLock::instance().get_stats();
+    std::printf("idle update(): %.1f ns/call, %u scanner updates, %u connection checks in %u calls\n", nanos,
+        node.lock().get_scanner_updates() - scanner_updates, after.connection_checks - before.connection_checks, calls);
+    CHECK_EQ(after.commands, before.commands);
+    CHECK_EQ(after.connection_checks, before.connection_checks);
+    CHECK_LE(node.lock().get_scanner_updates() - scanner_updates, 1u);
+}
+
+TEST_CASE(idle_node_checks_the_scanner_rarely) {
+    Node node;
+    node.setup();
+    settle(node);
+
+    const SmartLock::Stats before = SmartLock::instance().get_stats();
+    const uint32_t scanner_updates = node.lock().get_scanner_updates();
+    node.run_for(60000);
+
+    const SmartLock::Stats after = SmartLock::instance().get_stats();
+    CHECK_EQ(after.connection_checks, before.connection_checks);
+    CHECK_LE(node.lock().get_scanner_updates() - scanner_updates, 60000 / esphome::nuki_lock::BLE_IDLE_SCANNER_UPDATE_MILLIS + 1);
+    CHECK_GE(node.lock().get_scanner_updates() - scanner_updates, 60000 / esphome::nuki_lock::BLE_IDLE_SCANNER_UPDATE_MILLIS - 1);
+}
+
+TEST_CASE(connection_closes_after_an_idle_unlock) {
+    Node node;
+    node.setup();
+    settle(node);
+
+    node.lock().unlock();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_UNLOCKED; }, 10000));
+    CHECK(node.run_until([&]() { return !SmartLock::instance().is_connected(); }, 10000));
+}
+
+TEST_CASE(async_connection_closes_after_an_idle_unlock) {
+    NodeOptions options;
+    options.async_commands = true;
+    options.event_driven = true;
+    Node node(options);
+    node.setup();
+    settle(node);
+
+    node.lock().unlock();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_UNLOCKED; }, 10000));
+    CHECK(node.run_until([&]() { return !SmartLock::instance().is_connected(); }, 10000));
+}
+
+TEST_CASE(idle_node_still_sees_beacon_changes) {
+    Node node;
+    node.setup();
+    settle(node);
+    node.run_for(60000);
+
+    SmartLock::instance().turn(NukiLock::LockState::Unlocked);
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_UNLOCKED; }, 5000));
+}
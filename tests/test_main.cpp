@@ -0,0 +1,6 @@
+#include "harness.h"
+
+// Only linked into executables without their own main(), see nuki_trace_replay
+int main(int argc, char **argv) {
+    return nuki_test::run_tests(argc, argv);
+}
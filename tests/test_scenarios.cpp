@@ -0,0 +1,326 @@
+#include <string>
+#include <vector>
+
+#include "harness.h"
+
+using namespace nuki_test;
+using esphome::lock::LOCK_STATE_LOCKED;
+using esphome::lock::LOCK_STATE_NONE;
+using esphome::lock::LOCK_STATE_UNLOCKED;
+using NukiLock::LockState;
+
+// Scripted scenarios with budgets on what they may cost the lock battery and Home Assistant.
+// A regression like an extra refresh per action or a lost cooldown optimization fails here.
+// Every scenario runs twice, with blocking commands and on the BLE worker with event driven updates.
+
+namespace {
+
+// BLE and entity activity since the meter was started
+struct Usage
+{
+    uint32_t commands;
+    uint32_t connects;
+    uint32_t status_requests;
+    uint32_t config_requests;
+    uint32_t list_requests;
+    uint32_t publishes;
+};
+
+class Meter
+{
+    public:
+        Meter(const char *scenario, const NodeOptions &options) : scenario_(scenario), async_(options.async_commands) {
+            this->restart();
+        }
+
+        void restart() {
+            this->start_ = SmartLock::instance().get_stats();
+            this->start_publishes_ = esphome::EntityBase::get_total_publishes();
+        }
+
+        Usage used() const {
+            const SmartLock::Stats stats = SmartLock::instance().get_stats();
+            return Usage{
+                stats.commands - this->start_.commands,
+                stats.connects - this->start_.connects,
+                stats.status_requests - this->start_.status_requests,
+                stats.config_requests - this->start_.config_requests,
+                stats.list_requests - this->start_.list_requests,
+                esphome::EntityBase::get_total_publishes() - this->start_publishes_,
+            };
+        }
+
+        // Printed so budget changes can be based on the actual numbers
+        Usage report() const {
+            const Usage usage = this->used();
+            std::printf("%s%s: %u commands, %u connects, %u status, %u config, %u list, %u publishes\n", this->scenario_,
+                this->async_ ? " (async)" : "",
+                usage.commands, usage.connects, usage.status_requests, usage.config_requests, usage.list_requests, usage.publishes);
+            return usage;
+        }
+
+    protected:
+        const char *scenario_;
+        bool async_;
+        SmartLock::Stats start_;
+        uint32_t start_publishes_;
+};
+
+void settle(Node &node) {
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, 10000));
+    node.run_for(30000);
+    CHECK(!SmartLock::instance().is_connected());
+}
+
+// Virtual time until the lock reports state, the node runs meanwhile
+uint32_t time_until(Node &node, esphome::lock::LockState state, uint32_t timeout_millis) {
+    const uint32_t start = millis();
+    CHECK(node.run_until([&]() { return node.lock().state == state; }, timeout_millis));
+    return millis() - start;
+}
+
+NodeOptions async_options() {
+    NodeOptions options;
+    options.async_commands = true;
+    options.event_driven = true;
+    return options;
+}
+
+void enable_keypad() {
+    NukiLock::Config config = SmartLock::instance().get_config();
+    config.hasKeypadV2 = 1;
+    SmartLock::instance().change_config(config);
+}
+
+} //namespace
+
+#define SCENARIO(name) \
+    static void name(const NodeOptions &options); \
+    TEST_CASE(name##_blocking) { name(NodeOptions()); } \
+    TEST_CASE(name##_async) { name(async_options()); } \
+    static void name(const NodeOptions &options)
+
+SCENARIO(cold_boot) {
+    Meter meter("cold_boot", options);
+    Node node(options);
+    node.setup();
+    settle(node);
+
+    const Usage usage = meter.report();
+    // Status, config, advanced config, auth data and event log in one session
+    CHECK_LE(usage.commands, 6u);
+    CHECK_EQ(usage.connects, 1u);
+    CHECK_LE(usage.status_requests, 2u);
+    CHECK_EQ(usage.config_requests, 2u);
+    CHECK_LE(usage.list_requests, 2u);
+    CHECK_LE(usage.publishes, 25u);
+}
+
+SCENARIO(lock_and_unlock) {
+    Node node(options);
+    node.setup();
+    settle(node);
+
+    Meter meter("unlock", options);
+    node.lock().unlock();
+    const uint32_t unlock_millis = time_until(node, LOCK_STATE_UNLOCKED, 10000);
+    node.run_for(30000);
+    Usage usage = meter.report();
+    std::printf("unlock: confirmed after %ums\n", unlock_millis);
+
+    // The action and the status confirming it, no refreshes. Until three actions were
+    // measured, the status waits for the cooldown ceiling of lock actions.
+    CHECK_LE(unlock_millis, 6000u);
+    CHECK_LE(node.lock_action_latency.state, 6000.0f);
+    CHECK_LE(usage.commands, 3u);
+    CHECK_LE(usage.connects, 2u);
+    CHECK_EQ(usage.config_requests, 0u);
+    CHECK_EQ(usage.list_requests, 0u);
+    CHECK_LE(usage.publishes, 15u);
+
+    meter.restart();
+    node.lock().lock();
+    const uint32_t lock_millis = time_until(node, LOCK_STATE_LOCKED, 10000);
+    node.run_for(30000);
+    usage = meter.report();
+    std::printf("lock: confirmed after %ums\n", lock_millis);
+
+    CHECK_LE(lock_millis, 6000u);
+    CHECK_LE(usage.commands, 3u);
+    CHECK_LE(usage.connects, 2u);
+    CHECK_EQ(usage.config_requests, 0u);
+    CHECK_EQ(usage.list_requests, 0u);
+    CHECK_LE(usage.publishes, 15u);
+}
+
+SCENARIO(event_log_catch_up) {
+    // The first boot sets the cursor to the newest entry of the lock history
+    SmartLock::instance().add_log_entry(NukiLock::LoggingType::LockAction, 0, "Manual", NukiLock::LockAction::Lock);
+    {
+        Node node(options);
+        node.setup();
+        settle(node);
+        node.lock().on_safe_shutdown();
+    }
+
+    // The lock was used a lot while the node was offline
+    const uint32_t missed = 30;
+    for (uint32_t i = 0; i < missed; i++) {
+        SmartLock::instance().add_log_entry(NukiLock::LoggingType::LockAction, 0, "Manual",
+            i % 2 == 0 ? NukiLock::LockAction::Unlock : NukiLock::LockAction::Lock);
+    }
+
+    Meter meter("event_log_catch_up", options);
+    Node node(options);
+    node.setup();
+    settle(node);
+    node.run_for(60000);
+    const Usage usage = meter.report();
+
+    // Every missed entry exactly once, paged from the cached cursor
+    const size_t events = node.lock().get_fired_events().size();
+    std::printf("event_log_catch_up: %u events\n", static_cast<uint32_t>(events));
+    CHECK_EQ(events, missed);
+    CHECK_LE(usage.commands, 8u);
+    CHECK_LE(usage.connects, 2u);
+    CHECK_LE(usage.list_requests, 4u);
+    CHECK_LE(usage.publishes, 30u);
+}
+
+SCENARIO(keypad_batch) {
+    enable_keypad();
+    Node node(options);
+    node.setup();
+    settle(node);
+
+    Meter meter("keypad_batch", options);
+    CHECK(node.lock().call_service("keypad_batch",
+        std::vector<std::string>{"add", "add", "add", "add", "add"},
+        std::vector<int32_t>{0, 0, 0, 0, 0},
+        std::vector<std::string>{"Alice", "Bob", "Carol", "Dave", "Eve"},
+        std::vector<int32_t>{123456, 234567, 345678, 456789, 567891},
+        std::vector<bool>{true, true, true, true, true}));
+    CHECK(node.run_until([&]() { return SmartLock::instance().get_keypad_size() == 5; }, 30000));
+    node.run_for(30000);
+    const Usage usage = meter.report();
+
+    // All writes share one session, the keypad list is refreshed once afterwards
+    CHECK_EQ(SmartLock::instance().get_stats().keypad_writes, 5u);
+    CHECK_LE(usage.commands, 6u);
+    CHECK_LE(usage.connects, 2u);
+    CHECK_EQ(usage.config_requests, 0u);
+    CHECK_LE(usage.list_requests, 1u);
+    CHECK_LE(usage.publishes, 16u);
+}
+
+SCENARIO(unlock_storm) {
+    Node node(options);
+    node.setup();
+    settle(node);
+
+    // Automations and the dashboard fighting over the lock
+    Meter meter("unlock_storm", options);
+    for (int i = 0; i < 10; i++) {
+        if (i % 2 == 0) {
+            node.lock().unlock();
+        } else {
+            node.lock().lock();
+        }
+        node.run_for(200);
+    }
+    const uint32_t settle_millis = time_until(node, LOCK_STATE_LOCKED, 60000);
+    node.run_for(30000);
+    const Usage usage = meter.report();
+
+    CHECK(SmartLock::instance().get_state() == LockState::Locked);
+    // Requests queued behind a running action collapse into the latest one
+    CHECK_LE(settle_millis, 10000u);
+    CHECK_LE(usage.commands, 6u);
+    CHECK_LE(usage.connects, 4u);
+    CHECK_EQ(usage.config_requests, 0u);
+    CHECK_LE(usage.publishes, 30u);
+}
+
+SCENARIO(notification_flood) {
+    Node node(options);
+    node.setup();
+    settle(node);
+
+    // Beacons every 20 ms, each state change keeps the flag set until the status was read
+    SmartLock::instance().advertising_millis = 20;
+    Meter meter("notification_flood", options);
+    for (int i = 0; i < 5; i++) {
+        SmartLock::instance().turn(i % 2 == 0 ? LockState::Unlocked : LockState::Locked);
+        node.run_for(5000);
+    }
+    node.run_for(30000);
+    const Usage usage = meter.report();
+
+    CHECK(node.lock().state == LOCK_STATE_UNLOCKED);
+    // One status per change, not per beacon
+    CHECK_LE(usage.status_requests, 5u);
+    CHECK_LE(usage.commands, 6u);
+    CHECK_LE(usage.connects, 6u);
+    CHECK_EQ(usage.config_requests, 0u);
+    CHECK_LE(usage.publishes, 45u);
+}
+
+SCENARIO(flaky_link) {
+    Node node(options);
+    node.setup();
+    settle(node);
+
+    // Every third command times out, actions still go through
+    SmartLock::instance().fail_every(3);
+    Meter meter("flaky_link", options);
+    node.lock().unlock();
+    time_until(node, LOCK_STATE_UNLOCKED, 30000);
+    node.lock().lock();
+    time_until(node, LOCK_STATE_LOCKED, 30000);
+    node.run_for(30000);
+    Usage usage = meter.report();
+
+    CHECK_LE(usage.commands, 7u);
+    CHECK_LE(usage.connects, 6u);
+    CHECK_EQ(usage.config_requests, 0u);
+    CHECK_LE(usage.publishes, 35u);
+
+    // A dead link: the status errors climb until the state is given up, then it recovers
+    SmartLock::instance().fail_every(0);
+    SmartLock::instance().fail_next(20);
+    meter.restart();
+    SmartLock::instance().turn(LockState::Unlocked);
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_NONE; }, 60000));
+    CHECK(!node.connected.state);
+    time_until(node, LOCK_STATE_UNLOCKED, 60000);
+    node.run_for(30000);
+    usage = meter.report();
+
+    // One status retry per failure, every failure past the tolerated ones publishes the lost state
+    CHECK(node.connected.state);
+    CHECK_LE(usage.commands, 22u);
+    CHECK_LE(usage.status_requests, 21u);
+    CHECK_LE(usage.publishes, 160u);
+}
+
+SCENARIO(full_config_refresh) {
+    Node node(options);
+    node.setup();
+    settle(node);
+
+    // Settings changed in the Nuki app
+    Meter meter("full_config_refresh", options);
+    NukiLock::Config config = SmartLock::instance().get_config();
+    config.ledBrightness = 1;
+    SmartLock::instance().change_config(config);
+    CHECK(node.run_until([&]() { return meter.used().config_requests >= 2; }, 10000));
+    node.run_for(30000);
+    const Usage usage = meter.report();
+
+    // Status, config and advanced config over one connection
+    CHECK_EQ(usage.status_requests, 1u);
+    CHECK_EQ(usage.config_requests, 2u);
+    CHECK_LE(usage.commands, 3u);
+    CHECK_EQ(usage.connects, 1u);
+    CHECK_LE(usage.publishes, 16u);
+}
@@ -0,0 +1,172 @@
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "automation.h"
+#include "harness.h"
+
+using namespace nuki_test;
+using esphome::lock::LOCK_STATE_LOCKED;
+using esphome::lock::LOCK_STATE_NONE;
+using esphome::lock::LOCK_STATE_UNLOCKED;
+using NukiLock::LockState;
+
+TEST_CASE(boot_fetches_state_and_settings) {
+    Node node;
+    node.setup();
+
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, 10000));
+    node.run_for(10000);
+
+    const SmartLock::Stats stats = SmartLock::instance().get_stats();
+    CHECK_GE(stats.status_requests, 1u);
+    CHECK_EQ(stats.config_requests, 2u);
+    CHECK_EQ(stats.failures, 0u);
+    CHECK(node.paired.state);
+    CHECK_EQ(node.pin_state.state, std::string("Valid"));
+    CHECK(!SmartLock::instance().is_connected());
+}
+
+TEST_CASE(unlock_and_lock) {
+    Node node;
+    node.setup();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, 10000));
+    node.run_for(10000);
+
+    node.lock().unlock();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_UNLOCKED; }, 10000));
+    CHECK(SmartLock::instance().get_state() == LockState::Unlocked);
+
+    node.lock().lock();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, 10000));
+    CHECK(SmartLock::instance().get_state() == LockState::Locked);
+}
+
+TEST_CASE(manual_turn_is_picked_up_from_the_beacon) {
+    Node node;
+    node.setup();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, 10000));
+    node.run_for(10000);
+
+    SmartLock::instance().turn(LockState::Unlocked);
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_UNLOCKED; }, 5000));
+}
+
+TEST_CASE(async_unlock) {
+    NodeOptions options;
+    options.async_commands = true;
+    options.event_driven = true;
+    Node node(options);
+    node.setup();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, 10000));
+
+    node.lock().unlock();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_UNLOCKED; }, 10000));
+    CHECK(node.run_until([&]() { return node.lock().is_worker_idle(); }, 10000));
+}
+
+TEST_CASE(unpaired_node_stays_off_the_air) {
+    SmartLock::instance().paired = false;
+
+    Node node;
+    node.setup();
+    node.run_for(10000);
+
+    CHECK_EQ(SmartLock::instance().get_stats().commands, 0u);
+    CHECK(node.lock().state == LOCK_STATE_NONE);
+    CHECK(!node.paired.state);
+}
+
+TEST_CASE(pairing_mode_pairs_and_fetches_settings) {
+    SmartLock::instance().paired = false;
+
+    NodeOptions options;
+    options.pin_validated = false;
+    Node node(options);
+    esphome::nuki_lock::PairedTrigger paired_trigger(&node.lock());
+    node.setup();
+    node.run_for(2000);
+
+    node.lock().set_pairing_mode(true);
+    CHECK(node.run_until([&]() { return node.lock().is_paired() && node.lock().state == LOCK_STATE_LOCKED; }, 10000));
+    CHECK_EQ(paired_trigger.get_triggered(), 1u);
+    CHECK(node.run_until([&]() { return SmartLock::instance().get_stats().config_requests == 2; }, 10000));
+}
+
+TEST_CASE(failed_keypad_write_ends_the_batch_session) {
+    NukiLock::Config config = SmartLock::instance().get_config();
+    config.hasKeypadV2 = 1;
+    SmartLock::instance().change_config(config);
+
+    Node node;
+    node.setup();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, 10000));
+    node.run_for(30000);
+
+    // The only operation of the batch times out, it is reported and not retried
+    SmartLock::instance().fail_next(1);
+    CHECK(node.lock().call_service("keypad_batch", std::vector<std::string>{"add"}, std::vector<int32_t>{0},
+        std::vector<std::string>{"Alice"}, std::vector<int32_t>{123456}, std::vector<bool>{true}));
+    CHECK(node.run_until([&]() { return SmartLock::instance().get_stats().keypad_writes == 1; }, 5000));
+    CHECK(node.run_until([&]() { return !node.lock().is_session_open(); }, 5000));
+    CHECK_EQ(SmartLock::instance().get_keypad_size(), 0u);
+}
+
+TEST_CASE(keypad_batch_rejects_long_and_duplicate_names) {
+    NukiLock::Config config = SmartLock::instance().get_config();
+    config.hasKeypadV2 = 1;
+    SmartLock::instance().change_config(config);
+
+    Node node;
+    node.setup();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, 10000));
+    node.run_for(30000);
+
+    // Neither batch reaches the lock
+    CHECK(node.lock().call_service("keypad_batch", std::vector<std::string>{"add", "add"}, std::vector<int32_t>{0, 0},
+        std::vector<std::string>{"Alice", "Alice"}, std::vector<int32_t>{123456, 234567}, std::vector<bool>{true, true}));
+    CHECK(node.lock().call_service("keypad_batch", std::vector<std::string>{"add"}, std::vector<int32_t>{0},
+        std::vector<std::string>{"A name of more than twenty characters"}, std::vector<int32_t>{123456},
+        std::vector<bool>{true}));
+    node.run_for(10000);
+    CHECK_EQ(SmartLock::instance().get_stats().keypad_writes, 0u);
+    CHECK_EQ(SmartLock::instance().get_keypad_size(), 0u);
+}
+
+TEST_CASE(worker_keeps_slots_for_control_jobs) {
+    // Never stopped, the worker thread outlives the test
+    static esphome::nuki_lock::BleWorker worker;
+    CHECK(worker.start());
+
+    std::atomic<bool> release{false};
+    auto make_job = [&release]() {
+        auto *job = new esphome::nuki_lock::BleJob();
+        job->execute = [&release]() {
+            while (!release) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return Nuki::CmdResult::Success;
+        };
+        return job;
+    };
+
+    using esphome::nuki_lock::BLE_WORKER_CONTROL_SLOTS;
+    using esphome::nuki_lock::BLE_WORKER_QUEUE_SIZE;
+    for (size_t i = 0; i < BLE_WORKER_QUEUE_SIZE - BLE_WORKER_CONTROL_SLOTS; i++) {
+        CHECK(worker.submit(make_job()));
+    }
+    CHECK(!worker.submit(make_job()));
+    for (size_t i = 0; i < BLE_WORKER_CONTROL_SLOTS; i++) {
+        CHECK(worker.submit(make_job(), true));
+    }
+    CHECK(!worker.submit(make_job(), true));
+
+    release = true;
+    for (int i = 0; i < 1000 && !worker.is_idle(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        worker.process_completions();
+    }
+    CHECK(worker.is_idle());
+}
@@ -0,0 +1,117 @@
+#include <sstream>
+
+#include "trace_replay.h"
+
+using namespace nuki_test;
+using esphome::lock::LOCK_STATE_LOCKED;
+using esphome::lock::LOCK_STATE_UNLOCKED;
+using NukiLock::LockState;
+
+namespace {
+
+// Dumps the command trace through the service and reads it back from the log
+std::vector<TraceEntry> capture_trace(Node &node) {
+    std::ostringstream log;
+    esphome::set_log_listener([&](int level, const char *tag, const std::string &message) {
+        log << "[I][" << tag << "]: " << message << "\n";
+    });
+    node.lock().call_service("print_command_trace");
+    esphome::set_log_listener(nullptr);
+
+    std::istringstream input(log.str());
+    return parse_trace(input);
+}
+
+// Boot, two lock actions with a failing attempt, and a manual turn
+std::vector<TraceEntry> record_workload() {
+    Node node;
+    node.setup();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, 10000));
+    node.run_for(30000);
+
+    SmartLock::instance().fail_next(1);
+    node.lock().unlock();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_UNLOCKED; }, 30000));
+    node.run_for(20000);
+
+    node.lock().lock();
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, 30000));
+    node.run_for(20000);
+
+    SmartLock::instance().turn(LockState::Unlocked);
+    CHECK(node.run_until([&]() { return node.lock().state == LOCK_STATE_UNLOCKED; }, 10000));
+    node.run_for(30000);
+
+    return capture_trace(node);
+}
+
+} //namespace
+
+TEST_CASE(parse_skips_log_prefixes_and_other_lines) {
+    std::istringstream input(
+        "[12:00:01][I][nuki_lock.trace:027]: Command trace: 3 records (3 total)\n"
+        "[12:00:01][I][nuki_lock.trace:028]: trace,timestamp,call,result,duration\n"
+        "[12:00:01][I][nuki_lock.trace:032]: trace,5120,status,1,742\n"
+        "trace,9000,lock_action,3,2011\n"
+        "[12:00:01][D][nuki_lock.lock:123]: Lock state: locked\n"
+        "[12:00:01][I][nuki_lock.trace:032]: trace,9100,event,3,0\n");
+    const std::vector<TraceEntry> trace = parse_trace(input);
+
+    CHECK_EQ(trace.size(), 3u);
+    CHECK_EQ(trace[0].timestamp, 5120u);
+    CHECK_EQ(trace[0].call, std::string("status"));
+    CHECK_EQ(trace[0].duration_millis, 742u);
+    CHECK(trace[1].is_failure());
+    CHECK(trace[2].is_event());
+    CHECK(!trace[2].is_failure());
+}
+
+TEST_CASE(summary_counts_retries_after_disconnect_errors) {
+    const std::vector<TraceEntry> trace = {
+        {1000, "status", 1, 700},
+        {20000, "event", static_cast<int>(Nuki::EventType::BLE_ERROR_ON_DISCONNECT), 0},
+        {20100, "lock_action", 3, 2000},
+        {22500, "lock_action", 3, 2000},
+        {25000, "lock_action", 1, 800},
+        {60000, "status", 1, 700},
+    };
+    const TraceSummary summary = summarize(trace);
+
+    CHECK_EQ(summary.commands, 5u);
+    CHECK_EQ(summary.failures, 2u);
+    CHECK_EQ(summary.retries, 2u);
+    CHECK_EQ(summary.events, 1u);
+    CHECK_EQ(summary.disconnect_errors, 1u);
+    CHECK_EQ(summary.commands_after_disconnect_errors, 3u);
+    CHECK_EQ(summary.calls.at("lock_action").count, 3u);
+    CHECK_EQ(summary.calls.at("lock_action").max_millis, 2000u);
+    CHECK_EQ(summary.span_millis, 59000u);
+}
+
+TEST_CASE(dumped_trace_matches_the_lock) {
+    const std::vector<TraceEntry> trace = record_workload();
+    const SmartLock::Stats stats = SmartLock::instance().get_stats();
+    const TraceSummary summary = summarize(trace);
+    print_summary(stdout, "recorded", summary);
+
+    CHECK_EQ(summary.commands, stats.commands);
+    CHECK_EQ(summary.failures, stats.failures);
+    CHECK_EQ(summary.calls.at("lock_action").count, stats.lock_actions);
+    CHECK_GE(summary.events, 1u);
+}
+
+TEST_CASE(replay_reproduces_the_recorded_workload) {
+    const std::vector<TraceEntry> trace = record_workload();
+    const TraceSummary recorded = summarize(trace);
+
+    const ReplayResult replayed = replay(trace);
+    print_replay(stdout, recorded, replayed);
+
+    // Two actions, the failed attempt is retried by the component, and the manual turn
+    CHECK_EQ(replayed.lock_actions, 2u);
+    CHECK_EQ(replayed.manual_changes, 1u);
+    CHECK_EQ(replayed.stats.lock_actions, recorded.calls.at("lock_action").count);
+    CHECK_EQ(replayed.stats.failures, recorded.failures);
+    CHECK_LE(replayed.stats.commands, recorded.commands + 2);
+    CHECK_GE(replayed.stats.commands + 2, recorded.commands);
+}
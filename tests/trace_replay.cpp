@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+
+#include "trace_replay.h"
+
+namespace nuki_test {
+
+using esphome::lock::LOCK_STATE_LOCKED;
+
+static const int EVENT_KEY_TURNER_STATUS_UPDATED = static_cast<int>(Nuki::EventType::KeyTurnerStatusUpdated);
+static const int EVENT_BLE_ERROR_ON_DISCONNECT = static_cast<int>(Nuki::EventType::BLE_ERROR_ON_DISCONNECT);
+
+bool TraceEntry::is_failure() const {
+    return !this->is_event() && this->result != static_cast<int>(Nuki::CmdResult::Success);
+}
+
+std::vector<TraceEntry> parse_trace(std::istream &input) {
+    std::vector<TraceEntry> trace;
+    std::string line;
+
+    while (std::getline(input, line)) {
+        const size_t start = line.find("trace,");
+        if (start == std::string::npos) {
+            continue;
+        }
+
+        // The header line has no timestamp and is skipped like any malformed record
+        char call[32] = {0};
+        unsigned timestamp = 0;
+        int result = 0;
+        unsigned duration = 0;
+        if (sscanf(line.c_str() + start, "trace,%u,%31[^,],%d,%u", &timestamp, call, &result, &duration) != 4) {
+            continue;
+        }
+        trace.push_back(TraceEntry{timestamp, call, result, duration});
+    }
+
+    return trace;
+}
+
+TraceSummary summarize(const std::vector<TraceEntry> &trace) {
+    TraceSummary summary;
+    bool failed = false;
+    uint32_t last_failure = 0;
+    bool disconnect_error = false;
+    uint32_t last_disconnect_error = 0;
+
+    for (const TraceEntry &entry : trace) {
+        if (entry.is_event()) {
+            summary.events++;
+            if (entry.result == EVENT_BLE_ERROR_ON_DISCONNECT) {
+                summary.disconnect_errors++;
+                disconnect_error = true;
+                last_disconnect_error = entry.timestamp;
+            }
+            continue;
+        }
+
+        CallSummary &call = summary.calls[entry.call];
+        call.count++;
+        call.total_millis += entry.duration_millis;
+        call.max_millis = std::max(call.max_millis, entry.duration_millis);
+        summary.commands++;
+
+        if (failed && entry.timestamp - last_failure <= TRACE_RETRY_WINDOW_MILLIS) {
+            summary.retries++;
+        }
+        if (disconnect_error && entry.timestamp - last_disconnect_error <= TRACE_RETRY_WINDOW_MILLIS) {
+            summary.commands_after_disconnect_errors++;
+        }
+
+        if (entry.is_failure()) {
+            call.failures++;
+            summary.failures++;
+            failed = true;
+            last_failure = entry.timestamp;
+        }
+    }
+
+    if (!trace.empty()) {
+        summary.span_millis = trace.back().timestamp - trace.front().timestamp;
+    }
+    return summary;
+}
+
+void print_summary(FILE *out, const char *title, const TraceSummary &summary) {
+    fprintf(out, "%s: %u commands, %u failures, %u retries, %u events over %us\n", title, summary.commands,
+        summary.failures, summary.retries, summary.events, summary.span_millis / 1000);
+    if (summary.disconnect_errors > 0) {
+        fprintf(out, "  %u BLE_ERROR_ON_DISCONNECT notifications, followed by %u commands within %us\n",
+            summary.disconnect_errors, summary.commands_after_disconnect_errors, TRACE_RETRY_WINDOW_MILLIS / 1000);
+    }
+
+    fprintf(out, "  %-16s %7s %8s %8s %8s\n", "call", "count", "failures", "avg ms", "max ms");
+    for (const auto &call : summary.calls) {
+        fprintf(out, "  %-16s %7u %8u %8u %8u\n", call.first.c_str(), call.second.count, call.second.failures,
+            call.second.total_millis / call.second.count, call.second.max_millis);
+    }
+}
+
+namespace {
+
+enum class WorkloadType { LockAction, ManualChange };
+
+struct WorkloadItem
+{
+    uint32_t timestamp;
+    WorkloadType type;
+};
+
+std::vector<WorkloadItem> extract_workload(const std::vector<TraceEntry> &trace) {
+    std::vector<WorkloadItem> workload;
+    bool changed = false;
+    uint32_t last_change = 0;
+    bool action_failed = false;
+
+    for (const TraceEntry &entry : trace) {
+        if (entry.call == "lock_action") {
+            // Retries of a failed action are up to the component
+            const bool retry = changed && action_failed && entry.timestamp - last_change <= TRACE_RETRY_WINDOW_MILLIS;
+            if (!retry) {
+                workload.push_back(WorkloadItem{entry.timestamp, WorkloadType::LockAction});
+            }
+            changed = true;
+            last_change = entry.timestamp;
+            action_failed = entry.is_failure();
+        } else if (entry.is_event() && entry.result == EVENT_KEY_TURNER_STATUS_UPDATED) {
+            // The lock notifies with every beacon until the change was read
+            if (!changed || entry.timestamp - last_change > TRACE_ACTION_WINDOW_MILLIS) {
+                workload.push_back(WorkloadItem{entry.timestamp, WorkloadType::ManualChange});
+                changed = true;
+                last_change = entry.timestamp;
+                action_failed = false;
+            }
+        }
+    }
+
+    return workload;
+}
+
+std::deque<SmartLock::Outcome> extract_link(const std::vector<TraceEntry> &trace) {
+    std::deque<SmartLock::Outcome> link;
+    for (const TraceEntry &entry : trace) {
+        if (!entry.is_event()) {
+            link.push_back(SmartLock::Outcome{static_cast<Nuki::CmdResult>(entry.result), entry.duration_millis});
+        }
+    }
+    return link;
+}
+
+} //namespace
+
+ReplayResult replay(const std::vector<TraceEntry> &trace, const NodeOptions &options) {
+    ReplayResult result;
+    reset_world();
+    if (trace.empty()) {
+        return result;
+    }
+
+    const std::vector<WorkloadItem> workload = extract_workload(trace);
+    SmartLock &smart_lock = SmartLock::instance();
+    const uint32_t start_publishes = esphome::EntityBase::get_total_publishes();
+
+    Node node(options);
+    const uint32_t boot = millis();
+    uint32_t base = boot;
+    if (trace.front().timestamp < TRACE_BOOT_MILLIS) {
+        // Recorded from boot, the boot session meets the recorded link as well
+        smart_lock.script(extract_link(trace));
+        node.setup();
+    } else {
+        node.setup();
+        node.run_until([&]() { return node.lock().state == LOCK_STATE_LOCKED; }, TRACE_BOOT_MILLIS);
+        node.run_for(TRACE_BOOT_MILLIS);
+        smart_lock.reset_stats();
+        smart_lock.script(extract_link(trace));
+        base = millis() - trace.front().timestamp;
+    }
+
+    for (const WorkloadItem &item : workload) {
+        const uint32_t due = base + item.timestamp;
+        if (static_cast<int32_t>(due - millis()) > 0) {
+            node.run_for(due - millis());
+        }
+
+        if (item.type == WorkloadType::LockAction) {
+            if (node.lock().state == LOCK_STATE_LOCKED) {
+                node.lock().unlock();
+            } else {
+                node.lock().lock();
+            }
+            result.lock_actions++;
+        } else {
+            smart_lock.turn(smart_lock.get_state() == NukiLock::LockState::Locked ? NukiLock::LockState::Unlocked
+                                                                                 : NukiLock::LockState::Locked);
+            result.manual_changes++;
+        }
+    }
+
+    // Let the last commands and their follow-ups finish
+    node.run_for(TRACE_RETRY_WINDOW_MILLIS * 6);
+
+    result.stats = smart_lock.get_stats();
+    result.publishes = esphome::EntityBase::get_total_publishes() - start_publishes;
+    return result;
+}
+
+void print_replay(FILE *out, const TraceSummary &recorded, const ReplayResult &replayed) {
+    auto count = [&](const char *call) {
+        auto it = recorded.calls.find(call);
+        return it != recorded.calls.end() ? it->second.count : 0u;
+    };
+
+    fprintf(out, "replayed %u lock actions and %u manual changes\n", replayed.lock_actions, replayed.manual_changes);
+    fprintf(out, "  %-16s %9s %9s\n", "", "recorded", "replayed");
+    fprintf(out, "  %-16s %9u %9u\n", "commands", recorded.commands, replayed.stats.commands);
+    fprintf(out, "  %-16s %9u %9u\n", "failures", recorded.failures, replayed.stats.failures);
+    fprintf(out, "  %-16s %9u %9u\n", "lock_action", count("lock_action"), replayed.stats.lock_actions);
+    fprintf(out, "  %-16s %9u %9u\n", "status", count("status"), replayed.stats.status_requests);
+    fprintf(out, "  %-16s %9u %9u\n", "config", count("config") + count("advanced_config"), replayed.stats.config_requests);
+    fprintf(out, "  %-16s %9u %9u\n", "list", count("auth_data") + count("event_log") + count("keypad_data"),
+        replayed.stats.list_requests);
+    fprintf(out, "  %-16s %9s %9u\n", "connects", "-", replayed.stats.connects);
+    fprintf(out, "  %-16s %9s %9u\n", "publishes", "-", replayed.publishes);
+}
+
+} //namespace nuki_test
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+
+namespace nuki_test {
+
+// Commands this long after a failed one count as its retries
+static const uint32_t TRACE_RETRY_WINDOW_MILLIS = 10000;
+// Status notifications this long after a lock action or the first notification belong to that change
+static const uint32_t TRACE_ACTION_WINDOW_MILLIS = 10000;
+// A trace whose first record is this early was recorded from boot
+static const uint32_t TRACE_BOOT_MILLIS = 30000;
+
+// One record of CommandTrace::dump(): trace,<timestamp>,<call>,<result>,<duration>
+struct TraceEntry
+{
+    uint32_t timestamp;
+    std::string call;
+    int result;
+    uint32_t duration_millis;
+
+    bool is_event() const { return this->call == "event"; }
+    bool is_failure() const;
+};
+
+/**
+ * @brief Reads the records of a dumped command trace from a device log.
+ *
+ * Everything in front of "trace," on a line is skipped, so logs copied from the
+ * ESPHome dashboard, `esphome logs` or a serial console work as they are.
+ */
+std::vector<TraceEntry> parse_trace(std::istream &input);
+
+struct CallSummary
+{
+    uint32_t count = 0;
+    uint32_t failures = 0;
+    uint32_t total_millis = 0;
+    uint32_t max_millis = 0;
+};
+
+struct TraceSummary
+{
+    // BLE transactions by call, lock notifications are counted separately
+    std::map<std::string, CallSummary> calls;
+    uint32_t commands = 0;
+    uint32_t failures = 0;
+    // Commands within TRACE_RETRY_WINDOW_MILLIS after a failure
+    uint32_t retries = 0;
+    uint32_t events = 0;
+    uint32_t disconnect_errors = 0;
+    // Commands within TRACE_RETRY_WINDOW_MILLIS after a BLE_ERROR_ON_DISCONNECT notification
+    uint32_t commands_after_disconnect_errors = 0;
+    uint32_t span_millis = 0;
+};
+
+TraceSummary summarize(const std::vector<TraceEntry> &trace);
+void print_summary(FILE *out, const char *title, const TraceSummary &summary);
+
+struct ReplayResult
+{
+    // Workload derived from the trace
+    uint32_t lock_actions = 0;
+    uint32_t manual_changes = 0;
+    // What the component did with it
+    SmartLock::Stats stats;
+    uint32_t publishes = 0;
+};
+
+/**
+ * @brief Replays the workload and link conditions of a trace against the component.
+ *
+ * Lock actions that are not retries are requested again at their recorded time,
+ * status notifications without a lock action before them become manual turns. The
+ * recorded results and durations are scripted into the simulated lock in order, so
+ * a changed scheduler meets the same link. The trace has no lock action types, the
+ * replay toggles between unlock and lock.
+ *
+ * Starts from reset_world(), the recorded time line is replayed in virtual time.
+ */
+ReplayResult replay(const std::vector<TraceEntry> &trace, const NodeOptions &options = NodeOptions());
+void print_replay(FILE *out, const TraceSummary &recorded, const ReplayResult &replayed);
+
+} //namespace nuki_test